@@ -17,13 +17,16 @@
 
 #include <cstdlib>
 #include <cstring>
+#include <vector>
 #include <snappy-c.h>
 #include <zstd.h>
+#include <zstd_errors.h>
 
 #include "Common/Serialize/Serializer.h"
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Common/File/FileUtil.h"
 #include "Common/StringUtils.h"
+#include "Common/Thread/ParallelLoop.h"
 
 enum class SerializeCompressType {
 	NONE = 0,
@@ -33,6 +36,117 @@ enum class SerializeCompressType {
 
 static constexpr SerializeCompressType SAVE_TYPE = SerializeCompressType::ZSTD;
 
+// ZSTD states are written as a series of independent frames of this size, so that both compression
+// and decompression can be split across threads.  A series of frames is still a single valid zstd
+// stream, so older versions (and the simple path below) can decompress these just fine.
+static constexpr size_t ZSTD_CHUNK_SIZE = 4 * 1024 * 1024;
+
+static size_t ZstdChunkedCompressBound(size_t sz) {
+	size_t bound = 0;
+	for (size_t pos = 0; pos < sz; pos += ZSTD_CHUNK_SIZE)
+		bound += ZSTD_compressBound(std::min(ZSTD_CHUNK_SIZE, sz - pos));
+	return bound;
+}
+
+static bool ZstdChunkedCompress(const u8 *src, size_t sz, u8 *dest, size_t &destLen) {
+	int numChunks = (int)((sz + ZSTD_CHUNK_SIZE - 1) / ZSTD_CHUNK_SIZE);
+	// Each chunk compresses into its own worst case sized slot, then they get packed together.
+	std::vector<size_t> slotOffsets(numChunks);
+	std::vector<size_t> results(numChunks);
+	size_t offset = 0;
+	for (int i = 0; i < numChunks; ++i) {
+		slotOffsets[i] = offset;
+		offset += ZSTD_compressBound(std::min(ZSTD_CHUNK_SIZE, sz - i * ZSTD_CHUNK_SIZE));
+	}
+	_assert_(offset <= destLen);
+
+	ParallelRangeLoop(&g_threadManager, [&](int l, int h) {
+		ZSTD_CCtx *ctx = ZSTD_createCCtx();
+		for (int i = l; i < h; ++i) {
+			size_t chunkSize = std::min(ZSTD_CHUNK_SIZE, sz - i * ZSTD_CHUNK_SIZE);
+			size_t slotSize = ZSTD_compressBound(chunkSize);
+			if (!ctx) {
+				results[i] = (size_t)-ZSTD_error_memory_allocation;
+				continue;
+			}
+			// TODO: If free disk space is low, we could max this out to 22?
+			ZSTD_CCtx_reset(ctx, ZSTD_reset_session_and_parameters);
+			ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel, ZSTD_CLEVEL_DEFAULT);
+			ZSTD_CCtx_setParameter(ctx, ZSTD_c_checksumFlag, 1);
+			ZSTD_CCtx_setPledgedSrcSize(ctx, chunkSize);
+			results[i] = ZSTD_compress2(ctx, dest + slotOffsets[i], slotSize, src + i * ZSTD_CHUNK_SIZE, chunkSize);
+		}
+		ZSTD_freeCCtx(ctx);
+	}, 0, numChunks, 1);
+
+	size_t written = 0;
+	for (int i = 0; i < numChunks; ++i) {
+		if (ZSTD_isError(results[i])) {
+			ERROR_LOG(Log::SaveState, "ChunkReader: Compression failed: %s", ZSTD_getErrorName(results[i]));
+			return false;
+		}
+		// Slots only ever move backwards, so this is safe in place.
+		memmove(dest + written, dest + slotOffsets[i], results[i]);
+		written += results[i];
+	}
+	destLen = written;
+	return true;
+}
+
+static bool ZstdChunkedDecompress(const u8 *src, size_t sz, u8 *dest, size_t &destLen) {
+	struct Frame {
+		size_t srcOffset;
+		size_t srcSize;
+		size_t destOffset;
+		size_t destSize;
+	};
+
+	// Find the frames first.  Each knows its own size, so we don't need an index in the file.
+	std::vector<Frame> frames;
+	size_t pos = 0;
+	size_t outPos = 0;
+	while (pos < sz) {
+		size_t frameSize = ZSTD_findFrameCompressedSize(src + pos, sz - pos);
+		unsigned long long contentSize = ZSTD_getFrameContentSize(src + pos, sz - pos);
+		if (ZSTD_isError(frameSize) || contentSize == ZSTD_CONTENTSIZE_ERROR || contentSize == ZSTD_CONTENTSIZE_UNKNOWN || outPos + contentSize > destLen) {
+			frames.clear();
+			break;
+		}
+		frames.push_back({ pos, frameSize, outPos, (size_t)contentSize });
+		pos += frameSize;
+		outPos += (size_t)contentSize;
+	}
+
+	if (frames.size() <= 1) {
+		// Single frame (older states), or something unexpected - let zstd sort it out.
+		size_t status = ZSTD_decompress(dest, destLen, src, sz);
+		if (ZSTD_isError(status))
+			return false;
+		destLen = status;
+		return true;
+	}
+
+	std::vector<size_t> results(frames.size());
+	ParallelRangeLoop(&g_threadManager, [&](int l, int h) {
+		ZSTD_DCtx *ctx = ZSTD_createDCtx();
+		for (int i = l; i < h; ++i) {
+			const Frame &frame = frames[i];
+			if (!ctx)
+				results[i] = (size_t)-ZSTD_error_memory_allocation;
+			else
+				results[i] = ZSTD_decompressDCtx(ctx, dest + frame.destOffset, frame.destSize, src + frame.srcOffset, frame.srcSize);
+		}
+		ZSTD_freeDCtx(ctx);
+	}, 0, (int)frames.size(), 1);
+
+	for (size_t i = 0; i < frames.size(); ++i) {
+		if (ZSTD_isError(results[i]) || results[i] != frames[i].destSize)
+			return false;
+	}
+	destLen = outPos;
+	return true;
+}
+
 void PointerWrap::RewindForWrite(u8 *writePtr) {
 	_assert_(mode == MODE_MEASURE);
 	// Switch to writing mode, save the size for later checking and start again.
@@ -377,11 +491,7 @@ CChunkFileReader::Error CChunkFileReader::LoadFile(const Path &filename, std::st
 			auto status = snappy_uncompress((const char *)buffer, sz, (char *)uncomp_buffer, &uncomp_size);
 			success = status == SNAPPY_OK;
 		} else if (SerializeCompressType(header.Compress) == SerializeCompressType::ZSTD) {
-			size_t status = ZSTD_decompress((char *)uncomp_buffer, uncomp_size, (const char *)buffer, sz);
-			success = !ZSTD_isError(status);
-			if (success) {
-				uncomp_size = status;
-			}
+			success = ZstdChunkedDecompress(buffer, sz, uncomp_buffer, uncomp_size);
 		} else {
 			ERROR_LOG(Log::SaveState, "ChunkReader: Unexpected compression type %d", header.Compress);
 		}
@@ -435,7 +545,7 @@ CChunkFileReader::Error CChunkFileReader::SaveFile(const Path &filename, const s
 		write_len = snappy_max_compressed_length(sz);
 		break;
 	case SerializeCompressType::ZSTD:
-		write_len = ZSTD_compressBound(sz);
+		write_len = ZstdChunkedCompressBound(sz);
 		break;
 	}
 	u8 *compressed_buffer = write_len == 0 ? nullptr : (u8 *)malloc(write_len);
@@ -456,20 +566,7 @@ CChunkFileReader::Error CChunkFileReader::SaveFile(const Path &filename, const s
 			success = snappy_compress((const char *)buffer, sz, (char *)compressed_buffer, &write_len) == SNAPPY_OK;
 			break;
 		case SerializeCompressType::ZSTD:
-			{
-				auto ctx = ZSTD_createCCtx();
-				if (!ctx) {
-					success = false;
-				} else {
-					// TODO: If free disk space is low, we could max this out to 22?
-					ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel, ZSTD_CLEVEL_DEFAULT);
-					ZSTD_CCtx_setParameter(ctx, ZSTD_c_checksumFlag, 1);
-					ZSTD_CCtx_setPledgedSrcSize(ctx, sz);
-					write_len = ZSTD_compress2(ctx, compressed_buffer, write_len, buffer, sz);
-					success = !ZSTD_isError(write_len);
-				}
-				ZSTD_freeCCtx(ctx);
-			}
+			success = ZstdChunkedCompress(buffer, sz, compressed_buffer, write_len);
 			break;
 		}
 
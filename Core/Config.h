@@ -114,15 +114,21 @@ struct Config {
 	bool bHideSlowWarnings;
 	bool bHideStateWarnings;
 	bool bPreloadFunctions;
+	bool bIRDiskCache;
+	bool bIRBackgroundCompile;
+	bool bIRTraceFormation;
 	uint32_t uJitDisableFlags;
 
 	bool bDisableHTTPS;
 
 	bool bSeparateSASThread;
+	bool bParallelSASMix;
+	bool bVideoDecodeAhead;
 	int iIOTimingMethod;
 	int iLockedCPUSpeed;
 	bool bAutoSaveSymbolMap;
 	bool bCacheFullIsoInRam;
+	bool bMapIsoFiles;
 	int iRemoteISOPort;
 	std::string sLastRemoteISOServer;
 	int iLastRemoteISOPort;
@@ -169,6 +175,7 @@ struct Config {
 	bool bSoftwareRenderingJit;
 	bool bHardwareTransform; // only used in the GLES backend
 	bool bSoftwareSkinning;
+	bool bVertexCache;
 	bool bVendorBugChecksEnabled;
 	bool bUseGeometryShader;
 
@@ -295,6 +302,8 @@ struct Config {
 	int iAltSpeedVolume;
 
 	bool bExtraAudioBuffering;  // For bluetooth
+	int iAudioResampler;
+	int iAudioLatencyTargetMs;  // 0 = automatic
 	std::string sAudioDevice;
 	bool bAutoAudioDevice;
 	bool bUseOldAtrac;
@@ -125,6 +125,12 @@ enum AudioBackendType {
 	AUDIO_BACKEND_WASAPI,
 };
 
+// For iAudioResampler.
+enum AudioResamplerType {
+	AUDIO_RESAMPLER_LINEAR = 0,
+	AUDIO_RESAMPLER_SINC = 1,
+};
+
 // For iIOTimingMethod.
 enum IOTimingMethods {
 	IOTIMING_FAST = 0,
@@ -15,6 +15,7 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
 #include <atomic>
 #include <climits>
 #include <cstdio>
@@ -48,8 +49,23 @@ static std::set<int> usedEventTypes;
 static std::set<int> restoredEventTypes;
 static int nextEventTypeRestoreId = -1;
 
-Event *first;
-Event *eventPool = 0;
+// Pending events live in slots, and a binary heap of slot indices keeps them ordered by time.
+// Each slot is also chained to the other events of its type, so removing or finding events by
+// type doesn't need to look through everything else that's scheduled.
+struct Event : public BaseEvent {
+	// Events at the same time run in the order they were scheduled.
+	u64 order;
+	// -1 if the slot is free.
+	int heapIndex;
+	int prevOfType;
+	int nextOfType;
+};
+
+static std::vector<Event> eventSlots;
+static std::vector<int> freeSlots;
+static std::vector<int> eventHeap;
+static std::vector<int> firstOfType;
+static u64 nextEventOrder;
 
 // Downcount has been moved to currentMIPS, to save a couple of clocks in every ARM JIT block
 // as we can already reach that structure through a register.
@@ -106,28 +122,124 @@ u64 GetGlobalTimeUs() {
 	return lastGlobalTimeUs + usSinceLast;
 }
 
-const Event *GetFirstEvent() {
-	return first;
+static inline bool EventBefore(const Event &a, const Event &b) {
+	return a.time < b.time || (a.time == b.time && a.order < b.order);
 }
 
-const std::vector<EventType> &GetEventTypes() {
-	return event_types;
+static void HeapSet(int index, int slot) {
+	eventHeap[index] = slot;
+	eventSlots[slot].heapIndex = index;
 }
 
-Event* GetNewEvent()
-{
-	if(!eventPool)
-		return new Event;
+static void HeapSiftUp(int index) {
+	int slot = eventHeap[index];
+	while (index > 0) {
+		int parent = (index - 1) / 2;
+		if (!EventBefore(eventSlots[slot], eventSlots[eventHeap[parent]]))
+			break;
+		HeapSet(index, eventHeap[parent]);
+		index = parent;
+	}
+	HeapSet(index, slot);
+}
 
-	Event* ev = eventPool;
-	eventPool = ev->next;
-	return ev;
+static void HeapSiftDown(int index) {
+	const int size = (int)eventHeap.size();
+	int slot = eventHeap[index];
+	while (true) {
+		int child = index * 2 + 1;
+		if (child >= size)
+			break;
+		if (child + 1 < size && EventBefore(eventSlots[eventHeap[child + 1]], eventSlots[eventHeap[child]]))
+			child++;
+		if (!EventBefore(eventSlots[eventHeap[child]], eventSlots[slot]))
+			break;
+		HeapSet(index, eventHeap[child]);
+		index = child;
+	}
+	HeapSet(index, slot);
 }
 
-void FreeEvent(Event* ev)
-{
-	ev->next = eventPool;
-	eventPool = ev;
+static const Event *NextEvent() {
+	return eventHeap.empty() ? nullptr : &eventSlots[eventHeap[0]];
+}
+
+static void AddEvent(s64 time, int event_type, u64 userdata) {
+	int slot;
+	if (!freeSlots.empty()) {
+		// Usually the slot of the event that just ran, when it schedules itself again.
+		slot = freeSlots.back();
+		freeSlots.pop_back();
+	} else {
+		slot = (int)eventSlots.size();
+		eventSlots.push_back(Event{});
+	}
+
+	Event &ev = eventSlots[slot];
+	ev.time = time;
+	ev.userdata = userdata;
+	ev.type = event_type;
+	ev.order = nextEventOrder++;
+	ev.prevOfType = -1;
+	ev.nextOfType = -1;
+	if (event_type >= 0) {
+		if (event_type >= (int)firstOfType.size())
+			firstOfType.resize(event_type + 1, -1);
+		ev.nextOfType = firstOfType[event_type];
+		if (ev.nextOfType != -1)
+			eventSlots[ev.nextOfType].prevOfType = slot;
+		firstOfType[event_type] = slot;
+	}
+
+	// Most events are scheduled after everything else, so this rarely has to move far.
+	eventHeap.push_back(slot);
+	HeapSiftUp((int)eventHeap.size() - 1);
+}
+
+static void RemoveSlot(int slot) {
+	Event &ev = eventSlots[slot];
+	if (ev.prevOfType != -1)
+		eventSlots[ev.prevOfType].nextOfType = ev.nextOfType;
+	else if (ev.type >= 0)
+		firstOfType[ev.type] = ev.nextOfType;
+	if (ev.nextOfType != -1)
+		eventSlots[ev.nextOfType].prevOfType = ev.prevOfType;
+
+	int index = ev.heapIndex;
+	int last = eventHeap.back();
+	eventHeap.pop_back();
+	if (last != slot) {
+		HeapSet(index, last);
+		if (index > 0 && EventBefore(eventSlots[last], eventSlots[eventHeap[(index - 1) / 2]]))
+			HeapSiftUp(index);
+		else
+			HeapSiftDown(index);
+	}
+
+	ev.heapIndex = -1;
+	freeSlots.push_back(slot);
+}
+
+static std::vector<const Event *> GetSortedEvents() {
+	std::vector<const Event *> sorted;
+	sorted.reserve(eventHeap.size());
+	for (int slot : eventHeap)
+		sorted.push_back(&eventSlots[slot]);
+	std::sort(sorted.begin(), sorted.end(), [](const Event *a, const Event *b) {
+		return EventBefore(*a, *b);
+	});
+	return sorted;
+}
+
+std::vector<BaseEvent> GetScheduledEvents() {
+	std::vector<BaseEvent> events;
+	for (const Event *ev : GetSortedEvents())
+		events.push_back(*ev);
+	return events;
+}
+
+const std::vector<EventType> &GetEventTypes() {
+	return event_types;
 }
 
 int RegisterEvent(const char *name, TimedCallback callback) {
@@ -173,7 +285,7 @@ void RestoreRegisterEvent(int &event_type, const char *name, TimedCallback callb
 }
 
 void UnregisterAllEvents() {
-	_dbg_assert_msg_(first == nullptr, "Unregistering events with events pending - this isn't good.");
+	_dbg_assert_msg_(eventHeap.empty(), "Unregistering events with events pending - this isn't good.");
 	event_types.clear();
 	usedEventTypes.clear();
 	restoredEventTypes.clear();
@@ -196,11 +308,10 @@ void Shutdown()
 	ClearPendingEvents();
 	UnregisterAllEvents();
 
-	while (eventPool) {
-		Event *ev = eventPool;
-		eventPool = ev->next;
-		delete ev;
-	}
+	eventSlots.shrink_to_fit();
+	freeSlots.shrink_to_fit();
+	eventHeap.shrink_to_fit();
+	firstOfType.clear();
 }
  
 u64 GetTicks()
@@ -220,30 +331,11 @@ u64 GetIdleTicks()
 
 void ClearPendingEvents()
 {
-	while (first)
-	{
-		Event *e = first->next;
-		FreeEvent(first);
-		first = e;
-	}
-}
-
-void AddEventToQueue(Event* ne)
-{
-	Event* prev = NULL;
-	Event** pNext = &first;
-	for(;;)
-	{
-		Event*& next = *pNext;
-		if(!next || ne->time < next->time)
-		{
-			ne->next = next;
-			next = ne;
-			break;
-		}
-		prev = next;
-		pNext = &prev->next;
-	}
+	eventSlots.clear();
+	freeSlots.clear();
+	eventHeap.clear();
+	std::fill(firstOfType.begin(), firstOfType.end(), -1);
+	nextEventOrder = 0;
 }
 
 // This must be run ONLY from within the cpu thread
@@ -251,55 +343,31 @@ void AddEventToQueue(Event* ne)
 // than Advance
 void ScheduleEvent(s64 cyclesIntoFuture, int event_type, u64 userdata)
 {
-	Event *ne = GetNewEvent();
-	ne->userdata = userdata;
-	ne->type = event_type;
-	ne->time = GetTicks() + cyclesIntoFuture;
-	AddEventToQueue(ne);
+	AddEvent(GetTicks() + cyclesIntoFuture, event_type, userdata);
 }
 
 // Returns cycles left in timer.
 s64 UnscheduleEvent(int event_type, u64 userdata)
 {
+	if (event_type < 0 || event_type >= (int)firstOfType.size())
+		return 0;
+
+	// If there are several, report the one that would've run last.
+	const Event *latest = nullptr;
 	s64 result = 0;
-	if (!first)
-		return result;
-	while(first)
-	{
-		if (first->type == event_type && first->userdata == userdata)
-		{
-			result = first->time - GetTicks();
-
-			Event *next = first->next;
-			FreeEvent(first);
-			first = next;
-		}
-		else
-		{
-			break;
-		}
-	}
-	if (!first)
-		return result;
-	Event *prev = first;
-	Event *ptr = prev->next;
-	while (ptr)
-	{
-		if (ptr->type == event_type && ptr->userdata == userdata)
-		{
-			result = ptr->time - GetTicks();
-
-			prev->next = ptr->next;
-			FreeEvent(ptr);
-			ptr = prev->next;
-		}
-		else
-		{
-			prev = ptr;
-			ptr = ptr->next;
+	int slot = firstOfType[event_type];
+	while (slot != -1) {
+		int next = eventSlots[slot].nextOfType;
+		const Event &ev = eventSlots[slot];
+		if (ev.userdata == userdata) {
+			if (!latest || EventBefore(*latest, ev)) {
+				latest = &ev;
+				result = ev.time - GetTicks();
+			}
+			RemoveSlot(slot);
 		}
+		slot = next;
 	}
-
 	return result;
 }
 
@@ -309,66 +377,30 @@ void RegisterMHzChangeCallback(MHzChangeCallback callback) {
 
 bool IsScheduled(int event_type)
 {
-	if (!first)
-		return false;
-	Event *e = first;
-	while (e) {
-		if (e->type == event_type)
-			return true;
-		e = e->next;
-	}
-	return false;
+	return event_type >= 0 && event_type < (int)firstOfType.size() && firstOfType[event_type] != -1;
 }
 
 void RemoveEvent(int event_type)
 {
-	if (!first)
+	if (event_type < 0 || event_type >= (int)firstOfType.size())
 		return;
-	while(first)
-	{
-		if (first->type == event_type)
-		{
-			Event *next = first->next;
-			FreeEvent(first);
-			first = next;
-		}
-		else
-		{
-			break;
-		}
-	}
-	if (!first)
-		return;
-	Event *prev = first;
-	Event *ptr = prev->next;
-	while (ptr)
-	{
-		if (ptr->type == event_type)
-		{
-			prev->next = ptr->next;
-			FreeEvent(ptr);
-			ptr = prev->next;
-		}
-		else
-		{
-			prev = ptr;
-			ptr = ptr->next;
-		}
-	}
+	while (firstOfType[event_type] != -1)
+		RemoveSlot(firstOfType[event_type]);
 }
 
 void ProcessEvents() {
-	while (first) {
-		if (first->time <= (s64)GetTicks()) {
+	while (!eventHeap.empty()) {
+		const Event &first = eventSlots[eventHeap[0]];
+		if (first.time <= (s64)GetTicks()) {
 			// INFO_LOG(Log::CPU, "%s (%lld, %lld) ", first->name ? first->name : "?", (u64)GetTicks(), (u64)first->time);
-			Event *evt = first;
-			first = first->next;
-			if (evt->type >= 0 && evt->type < event_types.size()) {
-				event_types[evt->type].callback(evt->userdata, (int)(GetTicks() - evt->time));
+			// The callback will likely schedule more events, so take it out first.
+			BaseEvent evt = first;
+			RemoveSlot(eventHeap[0]);
+			if (evt.type >= 0 && evt.type < event_types.size()) {
+				event_types[evt.type].callback(evt.userdata, (int)(GetTicks() - evt.time));
 			} else {
-				_dbg_assert_msg_(false, "Bad event type %d", evt->type);
+				_dbg_assert_msg_(false, "Bad event type %d", evt.type);
 			}
-			FreeEvent(evt);
 		} else {
 			// Caught up to the current time.
 			break;
@@ -398,6 +430,7 @@ void Advance() {
 
 	ProcessEvents();
 
+	const Event *first = NextEvent();
 	if (!first) {
 		// This should never happen in PPSSPP.
 		if (slicelength < 10000) {
@@ -417,11 +450,8 @@ void Advance() {
 }
 
 void LogPendingEvents() {
-	Event *ptr = first;
-	while (ptr) {
-		//INFO_LOG(Log::CPU, "PENDING: Now: %lld Pending: %lld Type: %d", globalTimer, ptr->time, ptr->type);
-		ptr = ptr->next;
-	}
+	// for (const Event *ptr : GetSortedEvents())
+	//	INFO_LOG(Log::CPU, "PENDING: Now: %lld Pending: %lld Type: %d", globalTimer, ptr->time, ptr->type);
 }
 
 void Idle(int maxIdle) {
@@ -429,6 +459,7 @@ void Idle(int maxIdle) {
 	if (maxIdle != 0 && cyclesDown > maxIdle)
 		cyclesDown = maxIdle;
 
+	const Event *first = NextEvent();
 	if (first && cyclesDown > 0) {
 		int cyclesExecuted = slicelength - currentMIPS->downcount;
 		int cyclesNextEvent = (int) (first->time - globalTimer);
@@ -450,14 +481,12 @@ void Idle(int maxIdle) {
 }
 
 std::string GetScheduledEventsSummary() {
-	Event *ptr = first;
 	std::string text = "Scheduled events\n";
 	text.reserve(1000);
-	while (ptr) {
+	for (const Event *ptr : GetSortedEvents()) {
 		unsigned int t = ptr->type;
 		if (t >= event_types.size()) {
 			_dbg_assert_msg_(false, "Invalid event type %d", t);
-			ptr = ptr->next;
 			continue;
 		}
 		const char *name = event_types[t].name;
@@ -466,7 +495,6 @@ std::string GetScheduledEventsSummary() {
 		char temp[512];
 		snprintf(temp, sizeof(temp), "%s : %i %08x%08x\n", name, (int)ptr->time, (u32)(ptr->userdata >> 32), (u32)(ptr->userdata));
 		text += temp;
-		ptr = ptr->next;
 	}
 	return text;
 }
@@ -484,6 +512,37 @@ void Event_DoStateOld(PointerWrap &p, BaseEvent *ev) {
 	usedEventTypes.insert(ev->type);
 }
 
+// Same format as the linked list we used to keep: a 1 before each event in order, then a 0.
+static void DoEventQueue(PointerWrap &p, void (*doEvent)(PointerWrap &, BaseEvent *)) {
+	if (p.mode == PointerWrap::MODE_READ) {
+		ClearPendingEvents();
+		while (true) {
+			u8 shouldExist = 0;
+			Do(p, shouldExist);
+			if (shouldExist != 1) {
+				if (shouldExist != 0) {
+					WARN_LOG(Log::SaveState, "Savestate failure: incorrect item marker %d", shouldExist);
+					p.SetError(p.ERROR_FAILURE);
+				}
+				break;
+			}
+			BaseEvent ev{};
+			doEvent(p, &ev);
+			// Read in order, so ties keep their order.
+			AddEvent(ev.time, ev.type, ev.userdata);
+		}
+	} else {
+		for (const Event *ev : GetSortedEvents()) {
+			u8 shouldExist = 1;
+			Do(p, shouldExist);
+			BaseEvent copy = *ev;
+			doEvent(p, &copy);
+		}
+		u8 shouldExist = 0;
+		Do(p, shouldExist);
+	}
+}
+
 void DoState(PointerWrap &p) {
 	auto s = p.Section("CoreTiming", 1, 3);
 	if (!s)
@@ -508,11 +567,11 @@ void DoState(PointerWrap &p) {
 	restoredEventTypes.clear();
 
 	if (s >= 3) {
-		DoLinkedList<BaseEvent, GetNewEvent, FreeEvent, Event_DoState>(p, first, (Event **)nullptr);
+		DoEventQueue(p, &Event_DoState);
 		// This is here because we previously stored a second queue of "threadsafe" events. Gone now. Remove in the next section version upgrade.
 		DoIgnoreUnusedLinkedList(p);
 	} else {
-		DoLinkedList<BaseEvent, GetNewEvent, FreeEvent, Event_DoStateOld>(p, first, (Event **)nullptr);
+		DoEventQueue(p, &Event_DoStateOld);
 		DoIgnoreUnusedLinkedList(p);
 	}
 
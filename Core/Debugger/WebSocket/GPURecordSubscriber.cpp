@@ -32,6 +32,7 @@ struct WebSocketGPURecordState : public DebuggerSubscriber {
 
 protected:
 	bool pending_ = false;
+	bool failed_ = false;
 	std::string lastTicket_;
 	Path lastFilename_;
 };
@@ -64,6 +65,7 @@ void WebSocketGPURecordState::Dump(DebuggerRequest &req) {
 
 	bool result = gpuDebug->GetRecorder()->RecordNextFrame([=](const Path &filename) {
 		lastFilename_ = filename;
+		failed_ = filename.empty();
 		pending_ = false;
 	});
 
@@ -79,6 +81,16 @@ void WebSocketGPURecordState::Dump(DebuggerRequest &req) {
 
 // This handles the asynchronous gpu.record.dump response.
 void WebSocketGPURecordState::Broadcast(net::WebSocketServer *ws) {
+	if (failed_) {
+		DebuggerErrorEvent event("Unable to write GPU recording", LogLevel::LERROR);
+		event.ticketRaw = lastTicket_;
+		ws->Send(event);
+
+		failed_ = false;
+		lastTicket_.clear();
+		return;
+	}
+
 	if (!lastFilename_.empty()) {
 		FILE *fp = File::OpenCFile(lastFilename_, "rb");
 		if (!fp) {
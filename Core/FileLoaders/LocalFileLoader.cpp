@@ -21,6 +21,7 @@
 #include "Common/Log.h"
 #include "Common/File/FileUtil.h"
 #include "Common/File/DirListing.h"
+#include "Core/Config.h"
 #include "Core/FileLoaders/LocalFileLoader.h"
 
 #if PPSSPP_PLATFORM(ANDROID)
@@ -36,6 +37,13 @@
 #include <fcntl.h>
 #endif
 
+#if defined(LOCAL_FILE_LOADER_MMAP) && !defined(_WIN32)
+#include <sys/mman.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
 #ifdef HAVE_LIBRETRO_VFS
 #include <streams/file_stream.h>
 #endif
@@ -96,6 +104,9 @@ LocalFileLoader::LocalFileLoader(const Path &filename)
 	}
 
 	DetectSizeFd();
+#ifdef LOCAL_FILE_LOADER_MMAP
+	MapFile();
+#endif
 
 #else // _WIN32
 
@@ -118,10 +129,16 @@ LocalFileLoader::LocalFileLoader(const Path &filename)
 	}
 	filesize_ = end_offset.QuadPart;
 	SetFilePointerEx(handle_, zero, nullptr, FILE_BEGIN);
+#ifdef LOCAL_FILE_LOADER_MMAP
+	MapFile();
+#endif
 #endif // _WIN32
 }
 
 LocalFileLoader::~LocalFileLoader() {
+#ifdef LOCAL_FILE_LOADER_MMAP
+	UnmapFile();
+#endif
 #if defined(HAVE_LIBRETRO_VFS)
     filestream_close(handle_);
 #elif !defined(_WIN32)
@@ -135,6 +152,57 @@ LocalFileLoader::~LocalFileLoader() {
 #endif
 }
 
+#ifdef LOCAL_FILE_LOADER_MMAP
+void LocalFileLoader::MapFile() {
+	if (filesize_ == 0 || !g_Config.bMapIsoFiles) {
+		return;
+	}
+
+	// If mapping fails for any reason (odd filesystems, etc.), we just fall back to regular reads.
+#ifdef _WIN32
+	// Reads from network shares and removable drives can fail, which would crash us through the mapping.
+	wchar_t volume[MAX_PATH];
+	if (!GetVolumePathNameW(filename_.ToWString().c_str(), volume, MAX_PATH) || GetDriveTypeW(volume) != DRIVE_FIXED) {
+		INFO_LOG(Log::FileSystem, "LocalFileLoader: '%s' isn't on a fixed drive, using regular reads", filename_.c_str());
+		return;
+	}
+	mapping_ = CreateFileMapping(handle_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping_) {
+		WARN_LOG(Log::FileSystem, "LocalFileLoader: Failed to create mapping for '%s', using regular reads", filename_.c_str());
+		return;
+	}
+	mapped_ = (const u8 *)MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+	if (!mapped_) {
+		CloseHandle(mapping_);
+		mapping_ = 0;
+	}
+#else
+	void *ptr = mmap(nullptr, (size_t)filesize_, PROT_READ, MAP_SHARED, fd_, 0);
+	if (ptr != MAP_FAILED) {
+		mapped_ = (const u8 *)ptr;
+	}
+#endif
+
+	if (!mapped_) {
+		WARN_LOG(Log::FileSystem, "LocalFileLoader: Failed to map '%s', using regular reads", filename_.c_str());
+	}
+}
+
+void LocalFileLoader::UnmapFile() {
+	if (!mapped_) {
+		return;
+	}
+#ifdef _WIN32
+	UnmapViewOfFile(mapped_);
+	CloseHandle(mapping_);
+	mapping_ = 0;
+#else
+	munmap((void *)mapped_, (size_t)filesize_);
+#endif
+	mapped_ = nullptr;
+}
+#endif
+
 bool LocalFileLoader::Exists() {
 	// If we opened it for reading, it must exist.  Done.
 #if defined(HAVE_LIBRETRO_VFS)
@@ -177,6 +245,17 @@ size_t LocalFileLoader::ReadAt(s64 absolutePos, size_t bytes, size_t count, void
 		return 0;
 	}
 
+#ifdef LOCAL_FILE_LOADER_MMAP
+	if (mapped_) {
+		// Same semantics as the pread path: a short read at the end of the file, counted in whole items.
+		if (absolutePos < 0 || (u64)absolutePos >= filesize_)
+			return 0;
+		const size_t readSize = (size_t)std::min((u64)(bytes * count), filesize_ - (u64)absolutePos);
+		memcpy(data, mapped_ + absolutePos, readSize);
+		return readSize / bytes;
+	}
+#endif
+
 #if defined(HAVE_LIBRETRO_VFS)
     std::lock_guard<std::mutex> guard(readLock_);
 	filestream_seek(handle_, absolutePos, RETRO_VFS_SEEK_POSITION_START);
@@ -19,6 +19,7 @@
 
 #include <mutex>
 
+#include "ppsspp_config.h"
 #include "Common/CommonTypes.h"
 #include "Common/File/Path.h"
 #include "Core/Loaders.h"
@@ -32,6 +33,13 @@ typedef void *HANDLE;
 typedef RFILE* HANDLE;
 #endif
 
+// On 64-bit desktop-ish platforms, we can map the whole file so reads are a plain memcpy rather than a syscall.
+// Address space is plentiful there, and the OS page cache does the caching for us.
+// Off by default (MapIsoFiles), since a failed read through a mapping crashes instead of returning an error.
+#if PPSSPP_ARCH(64BIT) && !defined(HAVE_LIBRETRO_VFS) && !PPSSPP_PLATFORM(ANDROID) && !PPSSPP_PLATFORM(SWITCH) && !PPSSPP_PLATFORM(UWP)
+#define LOCAL_FILE_LOADER_MMAP 1
+#endif
+
 class LocalFileLoader : public FileLoader {
 public:
 	LocalFileLoader(const Path &filename);
@@ -46,6 +54,14 @@ class LocalFileLoader : public FileLoader {
 	size_t ReadAt(s64 absolutePos, size_t bytes, size_t count, void *data, Flags flags = Flags::NONE) override;
 
 private:
+#ifdef LOCAL_FILE_LOADER_MMAP
+	void MapFile();
+	void UnmapFile();
+	const u8 *mapped_ = nullptr;
+#ifdef _WIN32
+	HANDLE mapping_ = 0;
+#endif
+#endif
 #if !defined(_WIN32) && !defined(HAVE_LIBRETRO_VFS)
 	void DetectSizeFd();
 	int fd_ = -1;
@@ -24,6 +24,8 @@
 #include "Common/Swap.h"
 #include "Common/File/FileUtil.h"
 #include "Common/File/DirListing.h"
+#include "Common/Thread/Promise.h"
+#include "Common/Thread/ThreadManager.h"
 #include "Core/Loaders.h"
 #include "Core/FileSystems/BlockDevices.h"
 #include "libchdr/chd.h"
@@ -132,6 +134,11 @@ typedef struct ciso_header
 // TODO: Need much better error handling.
 
 static const u32 CSO_READ_BUFFER_SIZE = 256 * 1024;
+// How far ahead of a sequential reader to inflate, and how much inflated data to keep around.
+static const u32 CSO_PREFETCH_WINDOW_SIZE = 512 * 1024;
+static const u32 CSO_PREFETCH_CACHE_SIZE = 2 * 1024 * 1024;
+// Number of back-to-back contiguous reads before we consider the access pattern sequential.
+static const int CSO_PREFETCH_MIN_SEQUENTIAL = 2;
 
 CISOFileBlockDevice::CISOFileBlockDevice(FileLoader *fileLoader)
 	: BlockDevice(fileLoader)
@@ -198,6 +205,9 @@ CISOFileBlockDevice::CISOFileBlockDevice(FileLoader *fileLoader)
 
 	ver_ = hdr.ver;
 
+	prefetchWindowFrames_ = std::max(1U, CSO_PREFETCH_WINDOW_SIZE / std::max(frameSize, 1U));
+	maxCachedFrames_ = std::max(prefetchWindowFrames_ * 2, CSO_PREFETCH_CACHE_SIZE / std::max(frameSize, 1U));
+
 	// Double check that the CSO is not truncated.  In most cases, this will be the exact size.
 	u64 fileSize = fileLoader->FileSize();
 	u64 lastIndexPos = index[indexSize - 1] & 0x7FFFFFFF;
@@ -211,6 +221,11 @@ CISOFileBlockDevice::CISOFileBlockDevice(FileLoader *fileLoader)
 
 CISOFileBlockDevice::~CISOFileBlockDevice()
 {
+	{
+		std::unique_lock<std::mutex> guard(prefetchLock_);
+		prefetchCancel_ = true;
+		prefetchCond_.wait(guard, [&] { return !prefetchRunning_; });
+	}
 	delete [] index;
 	delete [] readBuffer;
 	delete [] zlibBuffer;
@@ -235,18 +250,21 @@ bool CISOFileBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached)
 	const size_t compressedReadSize = (size_t)(compressedReadEnd - compressedReadPos);
 	const u32 compressedOffset = (blockNumber & ((1 << blockShift) - 1)) * GetBlockSize();
 
-	bool plain = (idx & 0x80000000) != 0;
-	if (ver_ >= 2) {
-		// CSO v2+ requires blocks be uncompressed if large enough to be.  High bit means other things.
-		plain = compressedReadSize >= frameSize;
-	}
-	if (plain) {
+	const FrameFormat format = GetFrameFormat(frameNumber);
+	if (format == FrameFormat::PLAIN) {
 		int readSize = (u32)fileLoader_->ReadAt(compressedReadPos + compressedOffset, 1, GetBlockSize(), outPtr, flags);
 		if (readSize < GetBlockSize())
 			memset(outPtr + readSize, 0, GetBlockSize() - readSize);
+	} else if (format == FrameFormat::LZ4) {
+		ERROR_LOG(Log::Loader, "block %d: LZ4 compressed CSO frames are not supported", blockNumber);
+		NotifyReadError();
+		memset(outPtr, 0, GetBlockSize());
+		return false;
 	} else if (zlibBufferFrame == frameNumber) {
 		// We already have it.  Just apply the offset and copy.
 		memcpy(outPtr, zlibBuffer + compressedOffset, GetBlockSize());
+	} else if (ReadCachedFrame(frameNumber, blockNumber & ((1 << blockShift) - 1), 1, outPtr)) {
+		// Inflated ahead of time by the prefetcher.
 	} else {
 		const u32 readSize = (u32)fileLoader_->ReadAt(compressedReadPos, 1, compressedReadSize, readBuffer, flags);
 
@@ -285,6 +303,9 @@ bool CISOFileBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached)
 			memcpy(outPtr, zlibBuffer + compressedOffset, GetBlockSize());
 		}
 	}
+	if (!uncached) {
+		NotifyBlocksRead(blockNumber, blockNumber);
+	}
 	return true;
 }
 
@@ -328,6 +349,23 @@ bool CISOFileBlockDevice::ReadBlocks(u32 minBlock, int count, u8 *outPtr) {
 		const u32 frameReadSize = (u32)(frameReadEnd - frameReadPos);
 		const u32 frameBlockOffset = block & ((1 << blockShift) - 1);
 		const u32 frameBlocks = std::min(lastBlock - block + 1, blocksPerFrame - frameBlockOffset);
+		const FrameFormat format = GetFrameFormat(frame);
+		const bool plain = format == FrameFormat::PLAIN;
+
+		if (format == FrameFormat::LZ4) {
+			ERROR_LOG(Log::Loader, "Frame %d: LZ4 compressed CSO frames are not supported", frame);
+			NotifyReadError();
+			memset(outPtr, 0, frameBlocks * GetBlockSize());
+			block += frameBlocks;
+			outPtr += frameBlocks * GetBlockSize();
+			continue;
+		}
+
+		if (!plain && ReadCachedFrame(frame, frameBlockOffset, frameBlocks, outPtr)) {
+			block += frameBlocks;
+			outPtr += frameBlocks * GetBlockSize();
+			continue;
+		}
 
 		if (frameReadEnd > readBufferEnd) {
 			const s64 maxNeeded = totalReadEnd - frameReadPos;
@@ -343,7 +381,6 @@ bool CISOFileBlockDevice::ReadBlocks(u32 minBlock, int count, u8 *outPtr) {
 		}
 
 		u8 *rawBuffer = &readBuffer[frameReadPos - readBufferStart];
-		const int plain = idx & 0x80000000;
 		if (plain) {
 			memcpy(outPtr, rawBuffer + frameBlockOffset * GetBlockSize(), frameBlocks * GetBlockSize());
 		} else {
@@ -375,9 +412,128 @@ bool CISOFileBlockDevice::ReadBlocks(u32 minBlock, int count, u8 *outPtr) {
 	}
 
 	inflateEnd(&z);
+	NotifyBlocksRead(minBlock, lastBlock);
 	return true;
 }
 
+CISOFileBlockDevice::FrameFormat CISOFileBlockDevice::GetFrameFormat(u32 frame) const {
+	const u32 idx = index[frame];
+	if (ver_ >= 2) {
+		// CSO v2+ requires blocks be uncompressed if large enough to be, and the high bit means LZ4.
+		const u64 readPos = (u64)(idx & 0x7FFFFFFF) << indexShift;
+		const u64 readEnd = (u64)(index[frame + 1] & 0x7FFFFFFF) << indexShift;
+		if (readEnd - readPos >= frameSize)
+			return FrameFormat::PLAIN;
+		return (idx & 0x80000000) != 0 ? FrameFormat::LZ4 : FrameFormat::DEFLATE;
+	}
+	return (idx & 0x80000000) != 0 ? FrameFormat::PLAIN : FrameFormat::DEFLATE;
+}
+
+bool CISOFileBlockDevice::ReadCachedFrame(u32 frame, u32 blockOffset, u32 blocks, u8 *outPtr) {
+	std::unique_lock<std::mutex> guard(prefetchLock_);
+	// If the prefetcher is busy with exactly this frame, it'll be done sooner than if we start over.
+	prefetchCond_.wait(guard, [&] { return prefetchDecoding_ != frame; });
+
+	auto it = frameCache_.find(frame);
+	if (it == frameCache_.end()) {
+		return false;
+	}
+	frameCacheLRU_.splice(frameCacheLRU_.begin(), frameCacheLRU_, it->second.lruPos);
+	memcpy(outPtr, it->second.data.data() + blockOffset * GetBlockSize(), blocks * GetBlockSize());
+	return true;
+}
+
+// Call with prefetchLock_ held.
+void CISOFileBlockDevice::InsertCachedFrame(u32 frame, std::vector<u8> &&data) {
+	auto it = frameCache_.find(frame);
+	if (it != frameCache_.end()) {
+		it->second.data = std::move(data);
+		frameCacheLRU_.splice(frameCacheLRU_.begin(), frameCacheLRU_, it->second.lruPos);
+		return;
+	}
+
+	if (frameCache_.size() >= maxCachedFrames_) {
+		frameCache_.erase(frameCacheLRU_.back());
+		frameCacheLRU_.pop_back();
+	}
+	frameCacheLRU_.push_front(frame);
+	frameCache_[frame] = CachedFrame{ std::move(data), frameCacheLRU_.begin() };
+}
+
+void CISOFileBlockDevice::NotifyBlocksRead(u32 minBlock, u32 lastBlock) {
+	if (minBlock == nextSequentialBlock_) {
+		sequentialReads_++;
+	} else {
+		sequentialReads_ = 0;
+	}
+	nextSequentialBlock_ = lastBlock + 1;
+
+	std::lock_guard<std::mutex> guard(prefetchLock_);
+	if (sequentialReads_ < CSO_PREFETCH_MIN_SEQUENTIAL) {
+		// Random access, stop any read-ahead in progress.  Already inflated frames stay cached.
+		prefetchNext_ = 0;
+		prefetchEnd_ = 0;
+		return;
+	}
+
+	const u32 firstAhead = (lastBlock >> blockShift) + 1;
+	prefetchNext_ = std::max(prefetchNext_, firstAhead);
+	prefetchEnd_ = std::min(firstAhead + prefetchWindowFrames_, numFrames);
+	if (prefetchRunning_ || prefetchCancel_ || prefetchNext_ >= prefetchEnd_ || !g_threadManager.IsInitialized()) {
+		return;
+	}
+
+	prefetchRunning_ = true;
+	g_threadManager.EnqueueTask(new IndependentTask(TaskType::IO_BLOCKING, TaskPriority::NORMAL, [this]() {
+		PrefetchFrames();
+	}));
+}
+
+void CISOFileBlockDevice::PrefetchFrames() {
+	std::vector<u8> compressed;
+	z_stream z{};
+	const bool zlibReady = inflateInit2(&z, -15) == Z_OK;
+
+	std::unique_lock<std::mutex> guard(prefetchLock_);
+	while (zlibReady && !prefetchCancel_ && prefetchNext_ < prefetchEnd_) {
+		const u32 frame = prefetchNext_++;
+		// Plain frames don't need it, and LZ4 ones are reported by the reader.
+		if (GetFrameFormat(frame) != FrameFormat::DEFLATE || frameCache_.count(frame) != 0) {
+			continue;
+		}
+
+		prefetchDecoding_ = frame;
+		guard.unlock();
+
+		const u64 readPos = (u64)(index[frame] & 0x7FFFFFFF) << indexShift;
+		const u64 readEnd = (u64)(index[frame + 1] & 0x7FFFFFFF) << indexShift;
+		compressed.resize((size_t)(readEnd - readPos));
+		const size_t readSize = fileLoader_->ReadAt(readPos, 1, compressed.size(), compressed.data());
+
+		std::vector<u8> data(frameSize);
+		z.avail_in = (uInt)readSize;
+		z.next_in = compressed.data();
+		z.avail_out = frameSize;
+		z.next_out = data.data();
+		// Errors are left for the reader to find and report when it gets here.
+		const bool success = inflate(&z, Z_FINISH) == Z_STREAM_END && z.total_out == frameSize;
+		inflateReset(&z);
+
+		guard.lock();
+		if (success) {
+			InsertCachedFrame(frame, std::move(data));
+		}
+		prefetchDecoding_ = 0xFFFFFFFF;
+		prefetchCond_.notify_all();
+	}
+
+	if (zlibReady) {
+		inflateEnd(&z);
+	}
+	prefetchRunning_ = false;
+	prefetchCond_.notify_all();
+}
+
 NPDRMDemoBlockDevice::NPDRMDemoBlockDevice(FileLoader *fileLoader)
 	: BlockDevice(fileLoader)
 {
@@ -23,7 +23,11 @@
 // The ISOFileSystemReader reads from a BlockDevice, so it automatically works
 // with CISO images.
 
+#include <condition_variable>
+#include <list>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 
@@ -67,6 +71,24 @@ class CISOFileBlockDevice : public BlockDevice {
 	bool IsDisc() const override { return true; }
 
 private:
+	enum class FrameFormat {
+		PLAIN,
+		DEFLATE,
+		LZ4,
+	};
+
+	FrameFormat GetFrameFormat(u32 frame) const;
+	bool ReadCachedFrame(u32 frame, u32 blockOffset, u32 blocks, u8 *outPtr);
+	void InsertCachedFrame(u32 frame, std::vector<u8> &&data);
+	void NotifyBlocksRead(u32 minBlock, u32 lastBlock);
+	void PrefetchFrames();
+
+	struct CachedFrame {
+		std::vector<u8> data;
+		// Position in frameCacheLRU_.
+		std::list<u32>::iterator lruPos;
+	};
+
 	u32 *index = nullptr;
 	u8 *readBuffer = nullptr;
 	u8 *zlibBuffer = nullptr;
@@ -77,6 +99,25 @@ class CISOFileBlockDevice : public BlockDevice {
 	u32 numBlocks = 0;
 	u32 numFrames = 0;
 	int ver_ = 0;
+
+	// Read-ahead: when reads are sequential (streamed movies and audio), upcoming frames are
+	// inflated on a worker thread into a small LRU cache. Everything below is guarded by prefetchLock_,
+	// except the sequential access tracking which is only touched by the reading thread.
+	std::mutex prefetchLock_;
+	std::condition_variable prefetchCond_;
+	std::unordered_map<u32, CachedFrame> frameCache_;
+	// Frame numbers in frameCache_, most recently used first.
+	std::list<u32> frameCacheLRU_;
+	u32 maxCachedFrames_ = 0;
+	u32 prefetchWindowFrames_ = 0;
+	u32 prefetchNext_ = 0;
+	u32 prefetchEnd_ = 0;
+	u32 prefetchDecoding_ = 0xFFFFFFFF;
+	bool prefetchRunning_ = false;
+	bool prefetchCancel_ = false;
+
+	u32 nextSequentialBlock_ = 0xFFFFFFFF;
+	int sequentialReads_ = 0;
 };
 
 
@@ -40,6 +40,7 @@
 #include "Core/HLE/sceKernelThread.h"
 #include "Core/HLE/sceKernelInterrupt.h"
 #include "Core/HLE/HLE.h"
+#include "GPU/GPU.h"
 
 enum {
 	// Do nothing after the syscall.
@@ -820,8 +821,10 @@ void hleSetFlipTime(double t) {
 void CallSyscall(MIPSOpcode op) {
 	PROFILE_THIS_SCOPE("syscall");
 	double start = 0.0;  // need to initialize to fix the race condition where coreCollectDebugStats is enabled in the middle of this func.
+	double geStart = 0.0;
 	if (coreCollectDebugStats) {
 		start = time_now_d();
+		geStart = gpuStats.msProcessingDisplayLists;
 	}
 
 	const HLEFunction *info = GetSyscallFuncPointer(op);
@@ -849,6 +852,10 @@ void CallSyscall(MIPSOpcode op) {
 		int funcnum = callno & 0xFFF;
 		int modulenum = (callno & 0xFF000) >> 12;
 		double total = time_now_d() - start;
+		// Display lists run from sceGe calls are already counted as GPU time, so don't count them twice.
+		double geTime = gpuStats.msProcessingDisplayLists - geStart;
+		if (geTime > 0.0 && total >= geTime)
+			total -= geTime;
 		if (total >= hleFlipTime)
 			total -= hleFlipTime;
 		_dbg_assert_msg_(total >= 0.0, "Time spent in syscall became negative");
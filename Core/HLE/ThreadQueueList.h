@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <vector>
+#include "Common/BitSet.h"
 #include "Core/HLE/sceKernel.h"
 #include "Common/Serialize/Serializer.h"
 
@@ -27,31 +29,32 @@ struct ThreadQueueList {
 	static const int INITIAL_CAPACITY = 32;
 
 	struct Queue {
-		// Next ever-been-used queue (worse priority.)
-		Queue *next;
-		// First valid item in data.
-		int first;
-		// One after last valid item in data.
-		int end;
-		// A too-large array with room on the front and end.
+		// Circular array of thread ids.
 		SceUID *data;
-		// Size of data array.
+		// Index of the first valid item in data.
+		int first;
+		// Number of valid items.
+		int count;
+		// Size of data array, always a power of two.
 		int capacity;
 
 		inline int size() const {
-			return end - first;
+			return count;
 		}
 		inline bool empty() const {
-			return first == end;
+			return count == 0;
 		}
 		inline int full() const {
-			return end == capacity;
+			return count == capacity;
+		}
+		inline SceUID &at(int i) {
+			return data[(first + i) & (capacity - 1)];
 		}
 	};
 
 	ThreadQueueList() {
 		memset(queues, 0, sizeof(queues));
-		first = invalid();
+		memset(nonEmpty, 0, sizeof(nonEmpty));
 	}
 
 	~ThreadQueueList() {
@@ -61,12 +64,9 @@ struct ThreadQueueList {
 	// Only for debugging, returns priority level.
 	int contains(const SceUID uid) {
 		for (int i = 0; i < NUM_QUEUES; ++i) {
-			if (queues[i].data == nullptr)
-				continue;
-
 			Queue *cur = &queues[i];
-			for (int j = cur->first; j < cur->end; ++j) {
-				if (cur->data[j] == uid)
+			for (int j = 0; j < cur->size(); ++j) {
+				if (cur->at(j) == uid)
 					return i;
 			}
 		}
@@ -75,70 +75,63 @@ struct ThreadQueueList {
 	}
 
 	inline SceUID pop_first() {
-		Queue *cur = first;
-		while (cur != invalid()) {
-			if (cur->size() > 0)
-				return cur->data[cur->first++];
-			cur = cur->next;
-		}
+		int priority = firstNonEmpty(NUM_QUEUES);
+		if (priority >= 0)
+			return pop(priority);
 
 		_dbg_assert_msg_(false, "ThreadQueueList should not be empty.");
 		return 0;
 	}
 
 	inline SceUID pop_first_better(u32 priority) {
-		Queue *cur = first;
 		// Don't bother looking past (worse than) this priority.
-		Queue *stop = &queues[priority];
-		while (cur < stop) {
-			if (cur->size() > 0)
-				return cur->data[cur->first++];
-			cur = cur->next;
-		}
+		int better = firstNonEmpty(priority);
+		if (better >= 0)
+			return pop(better);
 
 		return 0;
 	}
 
 	inline SceUID peek_first() {
-		Queue *cur = first;
-		while (cur != invalid()) {
-			if (cur->size() > 0)
-				return cur->data[cur->first];
-			cur = cur->next;
-		}
+		int priority = firstNonEmpty(NUM_QUEUES);
+		if (priority >= 0)
+			return queues[priority].at(0);
 
 		return 0;
 	}
 
 	inline void push_front(u32 priority, const SceUID threadID) {
 		Queue *cur = &queues[priority];
-		cur->data[--cur->first] = threadID;
-		// If we ran out of room toward the front, add more room for next time.
-		if (cur->first == 0)
-			rebalance(priority);
+		if (cur->full())
+			grow(priority);
+		cur->first = (cur->first - 1) & (cur->capacity - 1);
+		cur->data[cur->first] = threadID;
+		cur->count++;
+		nonEmpty[priority >> 5] |= 1U << (priority & 31);
 	}
 
 	inline void push_back(u32 priority, const SceUID threadID) {
 		Queue *cur = &queues[priority];
-		cur->data[cur->end++] = threadID;
 		if (cur->full())
-			rebalance(priority);
+			grow(priority);
+		cur->count++;
+		cur->at(cur->count - 1) = threadID;
+		nonEmpty[priority >> 5] |= 1U << (priority & 31);
 	}
 
 	inline void remove(u32 priority, const SceUID threadID) {
 		Queue *cur = &queues[priority];
-		_dbg_assert_msg_(cur->next != nullptr, "ThreadQueueList::Queue should already be linked up.");
+		_dbg_assert_msg_(cur->data != nullptr, "ThreadQueueList::Queue should already be allocated.");
 
-		for (int i = cur->first; i < cur->end; ++i) {
-			if (cur->data[i] == threadID) {
-				// How many more after this one?
-				int remaining = cur->end - i;
-				// If there are more, move them into place.
-				if (remaining > 0)
-					memmove(&cur->data[i], &cur->data[i + 1], remaining * sizeof(SceUID));
+		for (int i = 0; i < cur->count; ++i) {
+			if (cur->at(i) == threadID) {
+				// Move the ones after it into place.
+				for (int j = i + 1; j < cur->count; ++j)
+					cur->at(j - 1) = cur->at(j);
 
 				// Now we're one shorter.
-				--cur->end;
+				if (--cur->count == 0)
+					nonEmpty[priority >> 5] &= ~(1U << (priority & 31));
 				return;
 			}
 		}
@@ -148,13 +141,13 @@ struct ThreadQueueList {
 
 	inline void rotate(u32 priority) {
 		Queue *cur = &queues[priority];
-		_dbg_assert_msg_(cur->next != nullptr, "ThreadQueueList::Queue should already be linked up.");
+		_dbg_assert_msg_(cur->data != nullptr, "ThreadQueueList::Queue should already be allocated.");
 
 		if (cur->size() > 1) {
-			// Grab the front and push it on the end.
-			cur->data[cur->end++] = cur->data[cur->first++];
-			if (cur->full())
-				rebalance(priority);
+			// Grab the front and put it on the end, which is where the front was.
+			SceUID front = cur->data[cur->first];
+			cur->first = (cur->first + 1) & (cur->capacity - 1);
+			cur->at(cur->count - 1) = front;
 		}
 	}
 
@@ -163,7 +156,7 @@ struct ThreadQueueList {
 			free(queues[i].data);
 		}
 		memset(queues, 0, sizeof(queues));
-		first = invalid();
+		memset(nonEmpty, 0, sizeof(nonEmpty));
 	}
 
 	inline bool empty(u32 priority) const {
@@ -173,7 +166,7 @@ struct ThreadQueueList {
 
 	inline void prepare(u32 priority) {
 		Queue *cur = &queues[priority];
-		if (cur->next == nullptr)
+		if (cur->data == nullptr)
 			link(priority, INITIAL_CAPACITY);
 	}
 
@@ -193,6 +186,7 @@ struct ThreadQueueList {
 		if (p.mode == p.MODE_READ)
 			clear();
 
+		std::vector<SceUID> items;
 		for (int i = 0; i < NUM_QUEUES; ++i) {
 			Queue *cur = &queues[i];
 			int size = cur->size();
@@ -204,85 +198,87 @@ struct ThreadQueueList {
 				continue;
 
 			if (p.mode == p.MODE_READ) {
+				if (size < 0 || size > capacity) {
+					p.SetError(p.ERROR_FAILURE);
+					ERROR_LOG(Log::sceKernel, "Savestate loading error: invalid data");
+					return;
+				}
 				link(i, capacity);
-				cur->first = (cur->capacity - size) / 2;
-				cur->end = cur->first + size;
+				if (size != 0) {
+					DoArray(p, cur->data, size);
+					cur->count = size;
+					nonEmpty[i >> 5] |= 1U << (i & 31);
+				}
+			} else if (size != 0) {
+				// Saved in order, same as when these weren't circular.
+				items.resize(size);
+				for (int j = 0; j < size; ++j)
+					items[j] = cur->at(j);
+				DoArray(p, items.data(), size);
 			}
-
-			if (size != 0)
-				DoArray(p, &cur->data[cur->first], size);
 		}
 	}
 
 private:
-	Queue *invalid() const {
-		return (Queue *)-1;
+	// Returns the best priority with any threads, if it's better than limit, otherwise -1.
+	inline int firstNonEmpty(u32 limit) const {
+		for (int i = 0; i < NUM_QUEUES / 32; ++i) {
+			if (nonEmpty[i] != 0) {
+				int priority = i * 32 + LeastSignificantSetBit(nonEmpty[i]);
+				return priority < (int)limit ? priority : -1;
+			}
+		}
+		return -1;
 	}
 
-	// Initialize a priority level and link to other queues.
+	inline SceUID pop(u32 priority) {
+		Queue *cur = &queues[priority];
+		SceUID threadID = cur->data[cur->first];
+		cur->first = (cur->first + 1) & (cur->capacity - 1);
+		if (--cur->count == 0)
+			nonEmpty[priority >> 5] &= ~(1U << (priority & 31));
+		return threadID;
+	}
+
+	// Initialize a priority level.
 	void link(u32 priority, int size) {
 		_dbg_assert_msg_(queues[priority].data == nullptr, "ThreadQueueList::Queue should only be initialized once.");
 
-		// Make sure we stay a multiple of INITIAL_CAPACITY.
-		if (size <= INITIAL_CAPACITY)
-			size = INITIAL_CAPACITY;
-		else {
-			int goal = size;
-			size = INITIAL_CAPACITY;
-			while (size < goal)
-				size *= 2;
-		}
+		// Make sure we stay a power of two, at least INITIAL_CAPACITY.
+		int goal = size;
+		size = INITIAL_CAPACITY;
+		while (size < goal)
+			size *= 2;
 
 		// Allocate the queue.
 		Queue *cur = &queues[priority];
 		cur->data = (SceUID *)malloc(sizeof(SceUID) * size);
 		cur->capacity = size;
-		// Start smack in the middle so it can move both directions.
-		cur->first = size / 2;
-		cur->end = size / 2;
-
-		for (int i = (int)priority - 1; i >= 0; --i) {
-			// This queue is before ours, and points past us.
-			// We'll have it point to our new queue, inserting into the chain.
-			if (queues[i].next != nullptr) {
-				cur->next = queues[i].next;
-				queues[i].next = cur;
-				return;
-			}
-		}
-
-		// Never found above - that means there's no better queue yet.
-		// The new one is now first, and whoever was first is after it.
-		cur->next = first;
-		first = cur;
+		cur->first = 0;
+		cur->count = 0;
 	}
 
-	// Move or allocate as necessary to maintain free space on both sides.
-	void rebalance(u32 priority) {
+	// Double the size, unwrapping the items to the start.
+	void grow(u32 priority) {
 		Queue *cur = &queues[priority];
-		int size = cur->size();
-		// Basically full.  Time for a larger queue?
-		if (size >= cur->capacity - 2) {
-			int new_capacity = cur->capacity * 2;
-			SceUID *new_data = (SceUID *)realloc(cur->data, new_capacity * sizeof(SceUID));
-			if (new_data != nullptr) {
-				// Success, it's bigger now.
-				cur->capacity = new_capacity;
-				cur->data = new_data;
-			}
+		if (cur->data == nullptr) {
+			link(priority, INITIAL_CAPACITY);
+			return;
 		}
 
-		// If we center all the items, it should start here.
-		int newFirst = (cur->capacity - size) / 2;
-		if (newFirst != cur->first) {
-			memmove(&cur->data[newFirst], &cur->data[cur->first], size * sizeof(SceUID));
-			cur->first = newFirst;
-			cur->end = newFirst + size;
-		}
+		int new_capacity = cur->capacity * 2;
+		SceUID *new_data = (SceUID *)malloc(new_capacity * sizeof(SceUID));
+		_assert_(new_data != nullptr);
+		for (int i = 0; i < cur->count; ++i)
+			new_data[i] = cur->at(i);
+		free(cur->data);
+		cur->data = new_data;
+		cur->capacity = new_capacity;
+		cur->first = 0;
 	}
 
-	// The first queue that's ever been used.
-	Queue *first;
+	// One bit for each priority level that has threads in it.
+	u32 nonEmpty[NUM_QUEUES / 32];
 	// The priority level queues of thread ids.
 	Queue queues[NUM_QUEUES];
 };
@@ -274,6 +274,8 @@ struct KernelStats {
 		summedMsInSyscalls.clear();
 		summedSlowestSyscallTime = 0;
 		summedSlowestSyscallName = 0;
+		numReschedules = 0;
+		numThreadSwitches = 0;
 	}
 
 	double msInSyscalls;
@@ -282,6 +284,8 @@ struct KernelStats {
 	std::map<KernelStatsSyscall, double> summedMsInSyscalls;
 	double summedSlowestSyscallTime;
 	const char *summedSlowestSyscallName;
+	int numReschedules;
+	int numThreadSwitches;
 };
 
 extern KernelStats kernelStats;
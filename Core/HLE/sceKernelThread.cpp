@@ -1749,6 +1749,8 @@ static PSPThread *__KernelNextThread() {
 
 void __KernelReSchedule(const char *reason)
 {
+	kernelStats.numReschedules++;
+
 	// First, let's check if there are any pending callbacks to trigger.
 	// TODO: Could probably take this out of __KernelReSchedule() which is a bit hot.
 	__KernelCheckCallbacks();
@@ -3016,6 +3018,7 @@ ThreadWaitInfo PSPThread::getWaitInfo() const {
 }
 
 void __KernelSwitchContext(PSPThread *target, const char *reason) {
+	kernelStats.numThreadSwitches++;
 	u32 oldPC = 0;
 	SceUID oldUID = 0;
 	const char *oldName = hleCurrentThreadName != NULL ? hleCurrentThreadName : "(none)";
@@ -109,17 +109,23 @@ struct BufferQueue {
 		return bytesgot;
 	}
 
-	int get_front(unsigned char *buf, int wantedsize) {
-		if (wantedsize <= 0)
+	// Peeks without popping, optionally skipping the first offset bytes.
+	int get_front(unsigned char *buf, int wantedsize, int offset = 0) {
+		if (wantedsize <= 0 || offset < 0)
+			return 0;
+		int bytesgot = getQueueSize() - offset;
+		if (bytesgot <= 0)
 			return 0;
-		int bytesgot = getQueueSize();
 		if (wantedsize < bytesgot)
 			bytesgot = wantedsize;
-		int firstSize = bufQueueSize - start;
+		int pos = start + offset;
+		if (pos >= bufQueueSize)
+			pos -= bufQueueSize;
+		int firstSize = bufQueueSize - pos;
 		if (bytesgot <= firstSize) {
-			memcpy(buf, bufQueue + start, bytesgot);
+			memcpy(buf, bufQueue + pos, bytesgot);
 		} else {
-			memcpy(buf, bufQueue + start, firstSize);
+			memcpy(buf, bufQueue + pos, firstSize);
 			memcpy(buf + firstSize, bufQueue, bytesgot - firstSize);
 		}
 		return bytesgot;
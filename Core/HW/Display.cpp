@@ -191,12 +191,15 @@ void __DisplayGetDebugStats(char *stats, size_t bufsize) {
 	snprintf(stats, bufsize,
 		"Kernel processing time: %0.2f ms\n"
 		"Slowest syscall: %s : %0.2f ms\n"
-		"Most active syscall: %s : %0.2f ms\n%s",
+		"Most active syscall: %s : %0.2f ms\n"
+		"Reschedules: %d (%d thread switches)\n%s",
 		kernelStats.msInSyscalls * 1000.0f,
 		kernelStats.slowestSyscallName ? kernelStats.slowestSyscallName : "(none)",
 		kernelStats.slowestSyscallTime * 1000.0f,
 		kernelStats.summedSlowestSyscallName ? kernelStats.summedSlowestSyscallName : "(none)",
 		kernelStats.summedSlowestSyscallTime * 1000.0f,
+		kernelStats.numReschedules,
+		kernelStats.numThreadSwitches,
 		statbuf);
 }
 
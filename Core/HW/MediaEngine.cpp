@@ -17,6 +17,9 @@
 
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Common/Math/SIMDHeaders.h"
+#include "Common/Thread/Promise.h"
+#include "Common/Thread/ThreadManager.h"
+#include "Core/Config.h"
 #include "Core/System.h"
 #include "Core/Debugger/MemBlockInfo.h"
 #include "Core/HW/MediaEngine.h"
@@ -145,6 +148,12 @@ void MediaEngine::DoState(PointerWrap &p) {
 	if (!s)
 		return;
 
+#ifdef USE_FFMPEG
+	// The worker may be reading m_pdata.
+	if (p.mode == p.MODE_READ)
+		stopDecodeAhead(false);
+#endif
+
 	Do(p, m_videoStream);
 	Do(p, m_audioStream);
 
@@ -218,6 +227,11 @@ int MediaEngine::MpegReadbuffer(void *opaque, uint8_t *buf, int buf_size) {
 		memcpy(buf, mpeg->m_mpegheader + mpeg->m_mpegheaderReadPos, size);
 		mpeg->m_mpegheaderReadPos += size;
 	} else {
+#ifdef USE_FFMPEG
+		// Only the worker decodes while it's running.
+		if (mpeg->m_aheadRunning)
+			return mpeg->readAhead(buf, buf_size);
+#endif
 		size = mpeg->m_pdata->pop_front(buf, buf_size);
 		if (size > 0)
 			mpeg->m_decodingsize = size;
@@ -340,6 +354,17 @@ bool MediaEngine::openContext(bool keepReadPos) {
 void MediaEngine::closeContext()
 {
 #ifdef USE_FFMPEG
+	stopDecodeAhead(false);
+	for (AheadFrame &ahead : m_aheadFrames) {
+		if (ahead.frame)
+			av_frame_free(&ahead.frame);
+		if (ahead.image)
+			av_free(ahead.image);
+		ahead.image = nullptr;
+	}
+	sws_freeContext(m_aheadSws);
+	m_aheadSws = nullptr;
+	m_aheadSwsFmt = -1;
 	if (m_buffer)
 		av_free(m_buffer);
 	if (m_pFrameRGB)
@@ -401,6 +426,7 @@ bool MediaEngine::addVideoStream(int streamNum, int streamId) {
 		// no need to add an existing stream.
 		if ((u32)streamNum < m_pFormatCtx->nb_streams)
 			return true;
+		stopDecodeAhead(true);
 		AVCodec *h264_codec = avcodec_find_decoder(AV_CODEC_ID_H264);
 		if (!h264_codec)
 			return false;
@@ -443,8 +469,11 @@ bool MediaEngine::addVideoStream(int streamNum, int streamId) {
 int MediaEngine::addStreamData(const u8 *buffer, int addSize) {
 	int size = addSize;
 	if (size > 0 && m_pdata) {
+		std::unique_lock<std::mutex> guard(m_aheadLock);
 		if (!m_pdata->push(buffer, size)) 
 			size  = 0;
+		m_aheadCond.notify_all();
+		guard.unlock();
 		if (m_demux) {
 			m_demux->addStreamData(buffer, addSize);
 		}
@@ -504,6 +533,7 @@ bool MediaEngine::setVideoStream(int streamNum, bool force) {
 	}
 
 #ifdef USE_FFMPEG
+	stopDecodeAhead(true);
 	if (m_pFormatCtx && m_pCodecCtxs.find(streamNum) == m_pCodecCtxs.end()) {
 		// Get a pointer to the codec context for the video stream
 		if ((u32)streamNum >= m_pFormatCtx->nb_streams) {
@@ -643,22 +673,15 @@ void MediaEngine::updateSwsFormat(int videoPixelMode) {
 #endif
 }
 
-bool MediaEngine::stepVideo(int videoPixelMode, bool skipFrame) {
 #ifdef USE_FFMPEG
-	auto codecIter = m_pCodecCtxs.find(m_videoStream);
-	AVCodecContext *m_pCodecCtx = codecIter == m_pCodecCtxs.end() ? 0 : codecIter->second;
-
-	if (!m_pFormatCtx)
-		return false;
-	if (!m_pCodecCtx)
-		return false;
-	if (!m_pFrame)
-		return false;
-
+// Reads and decodes until a frame comes out.  reachedEnd is set when we ran out of data instead.
+bool MediaEngine::decodeVideoFrame(AVCodecContext *codecCtx, AVFrame *frame, bool *reachedEnd, bool *videoEnd) {
 	AVPacket packet;
 	av_init_packet(&packet);
 	int frameFinished;
 	bool bGetFrame = false;
+	*reachedEnd = false;
+	*videoEnd = false;
 	while (!bGetFrame) {
 		bool dataEnd = av_read_frame(m_pFormatCtx, &packet) < 0;
 		// Even if we've read all frames, some may have been re-ordered frames at the end.
@@ -675,10 +698,10 @@ bool MediaEngine::stepVideo(int videoPixelMode, bool skipFrame) {
 
 #if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 48, 101)
 			if (packet.size != 0)
-				avcodec_send_packet(m_pCodecCtx, &packet);
-			int result = avcodec_receive_frame(m_pCodecCtx, m_pFrame);
+				avcodec_send_packet(codecCtx, &packet);
+			int result = avcodec_receive_frame(codecCtx, frame);
 			if (result == 0) {
-				result = m_pFrame->pkt_size;
+				result = frame->pkt_size;
 				frameFinished = 1;
 			} else if (result == AVERROR(EAGAIN)) {
 				result = 0;
@@ -687,55 +710,16 @@ bool MediaEngine::stepVideo(int videoPixelMode, bool skipFrame) {
 				frameFinished = 0;
 			}
 #else
-			int result = avcodec_decode_video2(m_pCodecCtx, m_pFrame, &frameFinished, &packet);
+			int result = avcodec_decode_video2(codecCtx, frame, &frameFinished, &packet);
 #endif
 			if (frameFinished) {
-				if (!m_pFrameRGB) {
-					setVideoDim();
-				}
-				if (m_pFrameRGB && !skipFrame) {
-					updateSwsFormat(videoPixelMode);
-					// TODO: Technically we could set this to frameWidth instead of m_desWidth for better perf.
-					// Update the linesize for the new format too.  We started with the largest size, so it should fit.
-					m_pFrameRGB->linesize[0] = getPixelFormatBytes(videoPixelMode) * m_desWidth;
-
-					sws_scale(m_sws_ctx, m_pFrame->data, m_pFrame->linesize, 0,
-						m_pCodecCtx->height, m_pFrameRGB->data, m_pFrameRGB->linesize);
-				}
-
-#if LIBAVUTIL_VERSION_MAJOR >= 59
-				int64_t bestPts = m_pFrame->best_effort_timestamp;
-				int64_t ptsDuration = m_pFrame->duration;
-#elif LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(55, 58, 100)
-				int64_t bestPts = m_pFrame->best_effort_timestamp;
-				int64_t ptsDuration = m_pFrame->pkt_duration;
-#else
-				int64_t bestPts = av_frame_get_best_effort_timestamp(m_pFrame);
-				int64_t ptsDuration = av_frame_get_pkt_duration(m_pFrame);
-#endif
-				if (ptsDuration == 0) {
-					if (m_lastPts == bestPts - m_firstTimeStamp || bestPts == AV_NOPTS_VALUE) {
-						// TODO: Assuming 29.97 if missing.
-						m_videopts += 3003;
-					} else {
-						m_videopts = bestPts - m_firstTimeStamp;
-						m_lastPts = m_videopts;
-					}
-				} else if (bestPts != AV_NOPTS_VALUE) {
-					m_videopts = bestPts + ptsDuration - m_firstTimeStamp;
-					m_lastPts = m_videopts;
-				} else {
-					m_videopts += ptsDuration;
-					m_lastPts = m_videopts;
-				}
 				bGetFrame = true;
 			}
 			if (result <= 0 && dataEnd) {
 				// Sometimes, m_readSize is less than m_streamSize at the end, but not by much.
 				// This is kinda a hack, but the ringbuffer would have to be prematurely empty too.
-				m_isVideoEnd = !bGetFrame && (m_pdata->getQueueSize() == 0);
-				if (m_isVideoEnd)
-					m_decodingsize = 0;
+				*reachedEnd = true;
+				*videoEnd = !bGetFrame && unreadQueueSize() == 0;
 				break;
 			}
 		}
@@ -746,6 +730,253 @@ bool MediaEngine::stepVideo(int videoPixelMode, bool skipFrame) {
 #endif
 	}
 	return bGetFrame;
+}
+
+void MediaEngine::updateVideoPts(const AVFrame *frame) {
+#if LIBAVUTIL_VERSION_MAJOR >= 59
+	int64_t bestPts = frame->best_effort_timestamp;
+	int64_t ptsDuration = frame->duration;
+#elif LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(55, 58, 100)
+	int64_t bestPts = frame->best_effort_timestamp;
+	int64_t ptsDuration = frame->pkt_duration;
+#else
+	int64_t bestPts = av_frame_get_best_effort_timestamp(frame);
+	int64_t ptsDuration = av_frame_get_pkt_duration(frame);
+#endif
+	if (ptsDuration == 0) {
+		if (m_lastPts == bestPts - m_firstTimeStamp || bestPts == AV_NOPTS_VALUE) {
+			// TODO: Assuming 29.97 if missing.
+			m_videopts += 3003;
+		} else {
+			m_videopts = bestPts - m_firstTimeStamp;
+			m_lastPts = m_videopts;
+		}
+	} else if (bestPts != AV_NOPTS_VALUE) {
+		m_videopts = bestPts + ptsDuration - m_firstTimeStamp;
+		m_lastPts = m_videopts;
+	} else {
+		m_videopts += ptsDuration;
+		m_lastPts = m_videopts;
+	}
+}
+
+int MediaEngine::unreadQueueSize() {
+	std::lock_guard<std::mutex> guard(m_aheadLock);
+	return m_pdata->getQueueSize() - m_aheadReadPos;
+}
+
+bool MediaEngine::hasDecodeAhead() {
+	std::lock_guard<std::mutex> guard(m_aheadLock);
+	return m_aheadRunning || m_aheadCount != 0;
+}
+
+void MediaEngine::startDecodeAhead(AVCodecContext *codecCtx, int videoPixelMode) {
+	std::lock_guard<std::mutex> guard(m_aheadLock);
+	m_aheadPixelMode = videoPixelMode;
+	if (m_aheadRunning || !m_pFrameRGB)
+		return;
+	// With more streams, the game might switch streams under us.
+	if (m_pFormatCtx->nb_streams != 1)
+		return;
+
+	if (!m_aheadFrames[0].frame) {
+		for (AheadFrame &ahead : m_aheadFrames) {
+			ahead.frame = av_frame_alloc();
+			// Big enough for any of the pixel formats.
+			ahead.image = (u8 *)av_malloc(m_desWidth * m_desHeight * 4);
+		}
+	}
+
+	m_aheadRunning = true;
+	m_aheadAbort = false;
+	m_aheadRelease = false;
+	g_threadManager.EnqueueTask(new IndependentTask(TaskType::DEDICATED_THREAD, TaskPriority::NORMAL, [this, codecCtx]() {
+		decodeAheadLoop(codecCtx);
+	}));
+}
+
+void MediaEngine::stopDecodeAhead(bool keepStream) {
+	std::unique_lock<std::mutex> guard(m_aheadLock);
+	if (m_aheadRunning) {
+		m_aheadAbort = true;
+		m_aheadCond.notify_all();
+		m_aheadCond.wait(guard, [this] { return !m_aheadRunning; });
+	}
+	if (keepStream && m_pdata && m_aheadReadPos > 0) {
+		// FFmpeg already has this data, so we just lose those frames.
+		WARN_LOG(Log::ME, "Dropping %d video frames that were decoded ahead", m_aheadCount);
+		m_pdata->pop_front(nullptr, m_aheadReadPos);
+	}
+	for (AheadFrame &ahead : m_aheadFrames) {
+		if (ahead.frame)
+			av_frame_unref(ahead.frame);
+	}
+	m_aheadFirst = 0;
+	m_aheadCount = 0;
+	m_aheadReadPos = 0;
+	m_aheadFrameReadSize = 0;
+	m_aheadFrameDecodingSize = 0;
+}
+
+void MediaEngine::decodeAheadLoop(AVCodecContext *codecCtx) {
+	std::unique_lock<std::mutex> guard(m_aheadLock);
+	while (!m_aheadAbort) {
+		if (m_aheadCount == VIDEO_AHEAD_FRAMES) {
+			m_aheadCond.wait(guard);
+			continue;
+		}
+
+		// Nothing else touches this slot until it's counted.
+		AheadFrame &ahead = m_aheadFrames[(m_aheadFirst + m_aheadCount) % VIDEO_AHEAD_FRAMES];
+		const int pixelMode = m_aheadPixelMode;
+		guard.unlock();
+
+		ahead.gotFrame = decodeVideoFrame(codecCtx, ahead.frame, &ahead.reachedEnd, &ahead.videoEnd);
+		ahead.pixelMode = -1;
+		if (ahead.gotFrame) {
+			AVPixelFormat swsDesired = getSwsFormat(pixelMode);
+			if (swsDesired != m_aheadSwsFmt) {
+				m_aheadSwsFmt = swsDesired;
+				m_aheadSws = sws_getCachedContext(m_aheadSws, codecCtx->width, codecCtx->height, codecCtx->pix_fmt,
+					m_desWidth, m_desHeight, swsDesired, SWS_BILINEAR, nullptr, nullptr, nullptr);
+				// Same as updateSwsFormat().
+				int *inv_coefficients;
+				int *coefficients;
+				int srcRange, dstRange;
+				int brightness, contrast, saturation;
+				if (m_aheadSws && sws_getColorspaceDetails(m_aheadSws, &inv_coefficients, &srcRange, &coefficients, &dstRange, &brightness, &contrast, &saturation) != -1) {
+					sws_setColorspaceDetails(m_aheadSws, inv_coefficients, 0, coefficients, 0, brightness, contrast, saturation);
+				}
+			}
+			if (m_aheadSws) {
+				uint8_t *destData[4] = { ahead.image };
+				int destLinesize[4] = { getPixelFormatBytes(pixelMode) * m_desWidth };
+				sws_scale(m_aheadSws, ahead.frame->data, ahead.frame->linesize, 0, codecCtx->height, destData, destLinesize);
+				ahead.pixelMode = pixelMode;
+			}
+		}
+
+		guard.lock();
+		ahead.readSize = m_aheadFrameReadSize;
+		ahead.decodingSize = m_aheadFrameDecodingSize;
+		m_aheadFrameReadSize = 0;
+		m_aheadFrameDecodingSize = 0;
+		m_aheadCount++;
+		m_aheadRelease = false;
+		m_aheadCond.notify_all();
+		// Out of data, let stepVideo() start us again once there's more.
+		if (!ahead.gotFrame)
+			break;
+	}
+	m_aheadRunning = false;
+	m_aheadCond.notify_all();
+}
+
+int MediaEngine::readAhead(uint8_t *buf, int buf_size) {
+	std::unique_lock<std::mutex> guard(m_aheadLock);
+	// A short read would look like the end of the data, so wait until the game asks for the frame.
+	m_aheadCond.wait(guard, [&] {
+		return m_pdata->getQueueSize() - m_aheadReadPos >= buf_size || m_aheadRelease || m_aheadAbort;
+	});
+	int size = m_pdata->get_front(buf, buf_size, m_aheadReadPos);
+	m_aheadReadPos += size;
+	m_aheadFrameReadSize += size;
+	if (size > 0)
+		m_aheadFrameDecodingSize = size;
+	return size;
+}
+
+bool MediaEngine::takeDecodedAhead(int videoPixelMode, bool skipFrame, bool *reachedEnd, bool *videoEnd) {
+	std::unique_lock<std::mutex> guard(m_aheadLock);
+	m_aheadPixelMode = videoPixelMode;
+	if (m_aheadCount == 0) {
+		// Not ready yet, so let the worker finish with what we have, like a direct decode would.
+		m_aheadRelease = true;
+		m_aheadCond.notify_all();
+		m_aheadCond.wait(guard, [this] { return m_aheadCount != 0 || !m_aheadRunning; });
+		if (m_aheadCount == 0)
+			return false;
+	}
+
+	AheadFrame &ahead = m_aheadFrames[m_aheadFirst];
+	// Now the data has really been consumed.
+	m_pdata->pop_front(nullptr, ahead.readSize);
+	m_aheadReadPos -= ahead.readSize;
+	guard.unlock();
+
+	if (ahead.decodingSize > 0)
+		m_decodingsize = ahead.decodingSize;
+	*reachedEnd = ahead.reachedEnd;
+	*videoEnd = ahead.videoEnd;
+	const bool bGetFrame = ahead.gotFrame;
+	if (bGetFrame) {
+		if (!skipFrame) {
+			m_pFrameRGB->linesize[0] = getPixelFormatBytes(videoPixelMode) * m_desWidth;
+			if (ahead.pixelMode == videoPixelMode) {
+				memcpy(m_pFrameRGB->data[0], ahead.image, m_pFrameRGB->linesize[0] * m_desHeight);
+			} else {
+				updateSwsFormat(videoPixelMode);
+				sws_scale(m_sws_ctx, ahead.frame->data, ahead.frame->linesize, 0,
+					ahead.frame->height, m_pFrameRGB->data, m_pFrameRGB->linesize);
+			}
+		}
+		updateVideoPts(ahead.frame);
+	}
+	av_frame_unref(ahead.frame);
+
+	guard.lock();
+	m_aheadFirst = (m_aheadFirst + 1) % VIDEO_AHEAD_FRAMES;
+	m_aheadCount--;
+	m_aheadCond.notify_all();
+	return bGetFrame;
+}
+#endif // USE_FFMPEG
+
+bool MediaEngine::stepVideo(int videoPixelMode, bool skipFrame) {
+#ifdef USE_FFMPEG
+	auto codecIter = m_pCodecCtxs.find(m_videoStream);
+	AVCodecContext *m_pCodecCtx = codecIter == m_pCodecCtxs.end() ? 0 : codecIter->second;
+
+	if (!m_pFormatCtx)
+		return false;
+	if (!m_pCodecCtx)
+		return false;
+	if (!m_pFrame)
+		return false;
+
+	bool reachedEnd = false;
+	bool videoEnd = false;
+	bool bGetFrame;
+	if (hasDecodeAhead()) {
+		bGetFrame = takeDecodedAhead(videoPixelMode, skipFrame, &reachedEnd, &videoEnd);
+	} else {
+		bGetFrame = decodeVideoFrame(m_pCodecCtx, m_pFrame, &reachedEnd, &videoEnd);
+		if (bGetFrame) {
+			if (!m_pFrameRGB) {
+				setVideoDim();
+			}
+			if (m_pFrameRGB && !skipFrame) {
+				updateSwsFormat(videoPixelMode);
+				// TODO: Technically we could set this to frameWidth instead of m_desWidth for better perf.
+				// Update the linesize for the new format too.  We started with the largest size, so it should fit.
+				m_pFrameRGB->linesize[0] = getPixelFormatBytes(videoPixelMode) * m_desWidth;
+
+				sws_scale(m_sws_ctx, m_pFrame->data, m_pFrame->linesize, 0,
+					m_pCodecCtx->height, m_pFrameRGB->data, m_pFrameRGB->linesize);
+			}
+			updateVideoPts(m_pFrame);
+		}
+	}
+
+	if (reachedEnd) {
+		m_isVideoEnd = videoEnd;
+		if (m_isVideoEnd)
+			m_decodingsize = 0;
+	}
+
+	if (bGetFrame && g_Config.bVideoDecodeAhead)
+		startDecodeAhead(m_pCodecCtx, videoPixelMode);
+	return bGetFrame;
 #else
 	// If video engine is not available, just add to the timestamp at least.
 	m_videopts += 3003;
@@ -24,7 +24,9 @@
 
 // An approximation of what the interface will look like. Similar to JPCSP's.
 
+#include <condition_variable>
 #include <map>
+#include <mutex>
 #include "Common/CommonTypes.h"
 #include "Core/HLE/sceMpeg.h"
 #include "Core/HW/MpegDemux.h"
@@ -101,6 +103,22 @@ class MediaEngine {
 
 	static int MpegReadbuffer(void *opaque, uint8_t *buf, int buf_size);
 
+#ifdef USE_FFMPEG
+	bool decodeVideoFrame(AVCodecContext *codecCtx, AVFrame *frame, bool *reachedEnd, bool *videoEnd);
+	void updateVideoPts(const AVFrame *frame);
+	int unreadQueueSize();
+
+	// Decode ahead: a worker decodes the next few frames (and converts them) while the game is busy.
+	// It only takes full reads from m_pdata, unless the game is already waiting on the frame, so the
+	// stream gets split up and decoded exactly like it would be when decoding on demand.
+	bool hasDecodeAhead();
+	void startDecodeAhead(AVCodecContext *codecCtx, int videoPixelMode);
+	void stopDecodeAhead(bool keepStream);
+	bool takeDecodedAhead(int videoPixelMode, bool skipFrame, bool *reachedEnd, bool *videoEnd);
+	void decodeAheadLoop(AVCodecContext *codecCtx);
+	int readAhead(uint8_t *buf, int buf_size);
+#endif
+
 public:  // TODO: Very little of this below should be public.
 
 #ifdef USE_FFMPEG
@@ -128,8 +146,40 @@ class MediaEngine {
 	std::vector<AVCodecContext *> m_codecsToClose;
 	AVIOContext *m_pIOContext = nullptr;
 	SwsContext *m_sws_ctx = nullptr;
+
+	enum { VIDEO_AHEAD_FRAMES = 3 };
+	struct AheadFrame {
+		AVFrame *frame = nullptr;
+		u8 *image = nullptr;
+		// -1 if image wasn't converted.
+		int pixelMode = -1;
+		// Bytes of m_pdata this frame used up.
+		int readSize = 0;
+		int decodingSize = 0;
+		bool gotFrame = false;
+		bool reachedEnd = false;
+		bool videoEnd = false;
+	};
+	AheadFrame m_aheadFrames[VIDEO_AHEAD_FRAMES];
+	SwsContext *m_aheadSws = nullptr;
+	int m_aheadSwsFmt = -1;
 #endif
 
+	// Protects the below, and m_pdata while decoding ahead.
+	std::mutex m_aheadLock;
+	std::condition_variable m_aheadCond;
+	bool m_aheadRunning = false;
+	bool m_aheadAbort = false;
+	// Set when the game wants a frame we don't have yet, reads then take whatever data there is.
+	bool m_aheadRelease = false;
+	int m_aheadPixelMode = 3;
+	int m_aheadFirst = 0;
+	int m_aheadCount = 0;
+	// Read by the worker but not yet popped from m_pdata.
+	int m_aheadReadPos = 0;
+	int m_aheadFrameReadSize = 0;
+	int m_aheadFrameDecodingSize = 0;
+
 	int m_sws_fmt = 0;
 	int m_videoStream = -1;
 	int m_expectedVideoStreams = 0;
@@ -17,9 +17,11 @@
 
 #include <algorithm>
 
+#include "Common/Math/SIMDHeaders.h"
 #include "Common/Profiler/Profiler.h"
 
 #include "Common/Serialize/SerializeFuncs.h"
+#include "Common/Thread/ParallelLoop.h"
 #include "Core/MemMapHelpers.h"
 #include "Core/HLE/sceAtrac.h"
 #include "Core/Config.h"
@@ -426,10 +428,14 @@ void SasInstance::ClearGrainSize() {
 	delete[] sendBuffer;
 	delete[] sendBufferDownsampled;
 	delete[] sendBufferProcessed;
+	delete[] voiceSamples_;
+	delete[] parallelMixTemp_;
 	mixBuffer = nullptr;
 	sendBuffer = nullptr;
 	sendBufferDownsampled = nullptr;
 	sendBufferProcessed = nullptr;
+	voiceSamples_ = nullptr;
+	parallelMixTemp_ = nullptr;
 }
 
 void SasInstance::SetGrainSize(int newGrainSize) {
@@ -440,11 +446,15 @@ void SasInstance::SetGrainSize(int newGrainSize) {
 	delete[] sendBuffer;
 	delete[] sendBufferDownsampled;
 	delete[] sendBufferProcessed;
+	delete[] voiceSamples_;
+	delete[] parallelMixTemp_;
 
 	mixBuffer = new s32[grainSize * 2];
 	sendBuffer = new s32[grainSize * 2];
 	sendBufferDownsampled = new s16[grainSize];
 	sendBufferProcessed = new s16[grainSize * 2];
+	voiceSamples_ = new s16[grainSize * PSP_SAS_VOICES_MAX];
+	parallelMixTemp_ = nullptr;
 	memset(mixBuffer, 0, sizeof(int) * grainSize * 2);
 	memset(sendBuffer, 0, sizeof(int) * grainSize * 2);
 	memset(sendBufferDownsampled, 0, sizeof(s16) * grainSize);
@@ -525,110 +535,183 @@ bool SasVoice::HaveSamplesEnded() const {
 	}
 }
 
-void SasInstance::MixVoice(SasVoice &voice) {
-	switch (voice.type) {
-	case VOICETYPE_VAG:
-		if (voice.type == VOICETYPE_VAG && !voice.vagAddr)
-			break;
-		// else fallthrough! Don't change the check above.
-		[[fallthrough]];
-	case VOICETYPE_PCM:
-		if (voice.type == VOICETYPE_PCM && !voice.pcmAddr)
-			break;
-		// else fallthrough! Don't change the check above.
-		[[fallthrough]];
-	default:
-		// This feels a bit hacky.  The first 32 samples after a keyon are 0s.
-		int delay = 0;
-		if (voice.envelope.NeedsKeyOn()) {
-			const bool ignorePitch = voice.type == VOICETYPE_PCM && voice.pitch > PSP_SAS_PITCH_BASE;
-			delay = ignorePitch ? 32 : (32 * (u32)voice.pitch) >> PSP_SAS_PITCH_BASE_SHIFT;
-			// VAG seems to have an extra sample delay (not shared by PCM.)
-			if (voice.type == VOICETYPE_VAG)
-				++delay;
-		}
+static bool IsSilentVoice(const SasVoice &voice) {
+	// These voices have no data, so they neither render nor walk their envelope.
+	return (voice.type == VOICETYPE_VAG && !voice.vagAddr) || (voice.type == VOICETYPE_PCM && !voice.pcmAddr);
+}
 
-		// Resample to the correct pitch, writing exactly "grainSize" samples. We need a buffer that can
-		// fit 4x that, as the max pitch is 0x4000.
-		// TODO: Special case no-resample case (and 2x and 0.5x) for speed, it's not uncommon
+void SasInstance::RenderVoice(SasVoice &voice, int16_t *mixTemp, int mixTempSize, s16 *out) {
+	// This feels a bit hacky.  The first 32 samples after a keyon are 0s.
+	int delay = 0;
+	if (voice.envelope.NeedsKeyOn()) {
+		const bool ignorePitch = voice.type == VOICETYPE_PCM && voice.pitch > PSP_SAS_PITCH_BASE;
+		delay = ignorePitch ? 32 : (32 * (u32)voice.pitch) >> PSP_SAS_PITCH_BASE_SHIFT;
+		// VAG seems to have an extra sample delay (not shared by PCM.)
+		if (voice.type == VOICETYPE_VAG)
+			++delay;
+	}
 
-		// Two passes: First read, then resample.
-		mixTemp_[0] = voice.resampleHist[0];
-		mixTemp_[1] = voice.resampleHist[1];
+	// Resample to the correct pitch, writing exactly "grainSize" samples. We need a buffer that can
+	// fit 4x that, as the max pitch is 0x4000.
+	// TODO: Special case no-resample case (and 2x and 0.5x) for speed, it's not uncommon
 
-		int voicePitch = voice.pitch;
-		u32 sampleFrac = voice.sampleFrac;
-		int samplesToRead = (sampleFrac + voicePitch * std::max(0, grainSize - delay)) >> PSP_SAS_PITCH_BASE_SHIFT;
-		if (samplesToRead > ARRAY_SIZE(mixTemp_) - 2) {
-			ERROR_LOG(Log::sceSas, "Too many samples to read (%d)! This shouldn't happen.", samplesToRead);
-			samplesToRead = ARRAY_SIZE(mixTemp_) - 2;
-		}
-		int readPos = 2;
-		if (voice.envelope.NeedsKeyOn()) {
-			readPos = 0;
-			samplesToRead += 2;
-		}
-		voice.ReadSamples(&mixTemp_[readPos], samplesToRead);
-		int tempPos = readPos + samplesToRead;
+	// Two passes: First read, then resample.
+	mixTemp[0] = voice.resampleHist[0];
+	mixTemp[1] = voice.resampleHist[1];
 
-		for (int i = 0; i < delay; ++i) {
-			// Walk the curve.  This means we'll reach ATTACK already, likely.
-			// This matches the results of tests (but maybe we can just remove the STATE_KEYON_STEP hack.)
-			voice.envelope.Step();
+	int voicePitch = voice.pitch;
+	u32 sampleFrac = voice.sampleFrac;
+	int samplesToRead = (sampleFrac + voicePitch * std::max(0, grainSize - delay)) >> PSP_SAS_PITCH_BASE_SHIFT;
+	if (samplesToRead > mixTempSize - 2) {
+		ERROR_LOG(Log::sceSas, "Too many samples to read (%d)! This shouldn't happen.", samplesToRead);
+		samplesToRead = mixTempSize - 2;
+	}
+	int readPos = 2;
+	if (voice.envelope.NeedsKeyOn()) {
+		readPos = 0;
+		samplesToRead += 2;
+	}
+	voice.ReadSamples(&mixTemp[readPos], samplesToRead);
+	int tempPos = readPos + samplesToRead;
+
+	for (int i = 0; i < delay; ++i) {
+		// Walk the curve.  This means we'll reach ATTACK already, likely.
+		// This matches the results of tests (but maybe we can just remove the STATE_KEYON_STEP hack.)
+		voice.envelope.Step();
+	}
+	if (delay > 0)
+		memset(out, 0, std::min(delay, grainSize) * sizeof(s16));
+
+	const bool needsInterp = voicePitch != PSP_SAS_PITCH_BASE || (sampleFrac & PSP_SAS_PITCH_MASK) != 0;
+	for (int i = delay; i < grainSize; i++) {
+		const int16_t *s = mixTemp + (sampleFrac >> PSP_SAS_PITCH_BASE_SHIFT);
+
+		// Linear interpolation. Good enough. Need to make resampleHist bigger if we want more.
+		int sample = s[0];
+		if (needsInterp) {
+			int f = sampleFrac & PSP_SAS_PITCH_MASK;
+			sample = (s[0] * (PSP_SAS_PITCH_MASK - f) + s[1] * f) >> PSP_SAS_PITCH_BASE_SHIFT;
 		}
+		sampleFrac += voicePitch;
+
+		// The maximum envelope height (PSP_SAS_ENVELOPE_HEIGHT_MAX) is (1 << 30) - 1.
+		// Reduce it to 14 bits, by shifting off 15.  Round up by adding (1 << 14) first.
+		int envelopeValue = voice.envelope.GetHeight();
+		voice.envelope.Step();
+		envelopeValue = (envelopeValue + (1 << 14)) >> 15;
+
+		// We just scale by the envelope before we scale by volumes.
+		// Again, we round up by adding (1 << 14) first (*after* multiplying.)
+		// The envelope is at most 1 << 15, so the result still fits in 16 bits.
+		out[i] = (s16)(((sample * envelopeValue) + (1 << 14)) >> 15);
+	}
 
-		const bool needsInterp = voicePitch != PSP_SAS_PITCH_BASE || (sampleFrac & PSP_SAS_PITCH_MASK) != 0;
-		for (int i = delay; i < grainSize; i++) {
-			const int16_t *s = mixTemp_ + (sampleFrac >> PSP_SAS_PITCH_BASE_SHIFT);
+	voice.resampleHist[0] = mixTemp[tempPos - 2];
+	voice.resampleHist[1] = mixTemp[tempPos - 1];
 
-			// Linear interpolation. Good enough. Need to make resampleHist bigger if we want more.
-			int sample = s[0];
-			if (needsInterp) {
-				int f = sampleFrac & PSP_SAS_PITCH_MASK;
-				sample = (s[0] * (PSP_SAS_PITCH_MASK - f) + s[1] * f) >> PSP_SAS_PITCH_BASE_SHIFT;
-			}
-			sampleFrac += voicePitch;
-
-			// The maximum envelope height (PSP_SAS_ENVELOPE_HEIGHT_MAX) is (1 << 30) - 1.
-			// Reduce it to 14 bits, by shifting off 15.  Round up by adding (1 << 14) first.
-			int envelopeValue = voice.envelope.GetHeight();
-			voice.envelope.Step();
-			envelopeValue = (envelopeValue + (1 << 14)) >> 15;
-
-			// We just scale by the envelope before we scale by volumes.
-			// Again, we round up by adding (1 << 14) first (*after* multiplying.)
-			sample = ((sample * envelopeValue) + (1 << 14)) >> 15;
-
-			// We mix into this 32-bit temp buffer and clip in a second loop
-			// Ideally, the shift right should be there too but for now I'm concerned about
-			// not overflowing.
-			mixBuffer[i * 2] += (sample * voice.volumeLeft) >> 12;
-			mixBuffer[i * 2 + 1] += (sample * voice.volumeRight) >> 12;
-			sendBuffer[i * 2] += sample * voice.effectLeft >> 12;
-			sendBuffer[i * 2 + 1] += sample * voice.effectRight >> 12;
-		}
+	voice.sampleFrac = sampleFrac - (tempPos - 2) * PSP_SAS_PITCH_BASE;
 
-		voice.resampleHist[0] = mixTemp_[tempPos - 2];
-		voice.resampleHist[1] = mixTemp_[tempPos - 1];
+	if (voice.HaveSamplesEnded())
+		voice.envelope.End();
+	if (voice.envelope.HasEnded()) {
+		// NOTICE_LOG(Log::SasMix, "Hit end of envelope");
+		voice.playing = false;
+		voice.on = false;
+	}
+}
 
-		voice.sampleFrac = sampleFrac - (tempPos - 2) * PSP_SAS_PITCH_BASE;
+static inline bool FitsS16(int v) {
+	return v >= -32768 && v <= 32767;
+}
 
-		if (voice.HaveSamplesEnded())
-			voice.envelope.End();
-		if (voice.envelope.HasEnded()) {
-			// NOTICE_LOG(Log::SasMix, "Hit end of envelope");
-			voice.playing = false;
-			voice.on = false;
+// Adds (sample * volume) >> 12 into an interleaved stereo buffer.
+static void AccumulateStereo(s32 *dest, const s16 *samples, int count, int volLeft, int volRight) {
+	int i = 0;
+	// Volumes are limited to PSP_SAS_VOL_MAX by sceSas, but savestates could have anything.
+	if (FitsS16(volLeft) && FitsS16(volRight)) {
+#ifdef _M_SSE
+		// Zero extending the samples to 32 bits lets madd do an exact 16x16->32 multiply, already in L/R order.
+		const __m128i vols = _mm_set_epi32(volRight & 0xFFFF, volLeft & 0xFFFF, volRight & 0xFFFF, volLeft & 0xFFFF);
+		const __m128i zero = _mm_setzero_si128();
+		for (; i + 4 <= count; i += 4) {
+			__m128i s = _mm_loadl_epi64((const __m128i *)(samples + i));
+			// s0 s0 s1 s1 s2 s2 s3 s3
+			__m128i dup = _mm_unpacklo_epi16(s, s);
+			__m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(dup, zero), vols);
+			__m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(dup, zero), vols);
+			__m128i *d = (__m128i *)(dest + i * 2);
+			_mm_storeu_si128(d, _mm_add_epi32(_mm_loadu_si128(d), _mm_srai_epi32(lo, 12)));
+			_mm_storeu_si128(d + 1, _mm_add_epi32(_mm_loadu_si128(d + 1), _mm_srai_epi32(hi, 12)));
 		}
+#elif PPSSPP_ARCH(ARM_NEON)
+		for (; i + 4 <= count; i += 4) {
+			int16x4_t s = vld1_s16(samples + i);
+			int32x4x2_t d = vld2q_s32(dest + i * 2);
+			d.val[0] = vaddq_s32(d.val[0], vshrq_n_s32(vmull_n_s16(s, (int16_t)volLeft), 12));
+			d.val[1] = vaddq_s32(d.val[1], vshrq_n_s32(vmull_n_s16(s, (int16_t)volRight), 12));
+			vst2q_s32(dest + i * 2, d);
+		}
+#endif
+	}
+	// This does the remainder if SIMD was used, otherwise it does it all.
+	for (; i < count; i++) {
+		dest[i * 2] += (samples[i] * volLeft) >> 12;
+		dest[i * 2 + 1] += (samples[i] * volRight) >> 12;
 	}
 }
 
+void SasInstance::AccumulateVoice(const SasVoice &voice, const s16 *samples) {
+	// We mix into these 32-bit temp buffers and clip in a second loop
+	// Ideally, the shift right should be there too but for now I'm concerned about
+	// not overflowing.
+	AccumulateStereo(mixBuffer, samples, grainSize, voice.volumeLeft, voice.volumeRight);
+	AccumulateStereo(sendBuffer, samples, grainSize, voice.effectLeft, voice.effectRight);
+}
+
 void SasInstance::Mix(u32 outAddr, u32 inAddr, int leftVol, int rightVol) {
+	int active[PSP_SAS_VOICES_MAX];
+	int activeCount = 0;
+	int parallelCount = 0;
 	for (int v = 0; v < PSP_SAS_VOICES_MAX; v++) {
 		SasVoice &voice = voices[v];
-		if (!voice.playing || voice.paused)
+		if (!voice.playing || voice.paused || IsSilentVoice(voice))
 			continue;
-		MixVoice(voice);
+		active[activeCount++] = v;
+		// Atrac voices decode through shared HLE state, so they always stay on this thread.
+		if (voice.type != VOICETYPE_ATRAC3)
+			parallelCount++;
+	}
+
+	// Voices only touch their own state while rendering, and we add them up in voice order afterwards,
+	// so the output is identical whether or not we spread the rendering over threads.
+	const int mixTempSize = grainSize * 4 + 2 + 16;
+	if (g_Config.bParallelSASMix && parallelCount >= 4 && grainSize > 0) {
+		if (!parallelMixTemp_)
+			parallelMixTemp_ = new int16_t[mixTempSize * PSP_SAS_VOICES_MAX];
+
+		ParallelRangeLoop(&g_threadManager, [&](int l, int h) {
+			for (int i = l; i < h; i++) {
+				const int v = active[i];
+				if (voices[v].type != VOICETYPE_ATRAC3)
+					RenderVoice(voices[v], parallelMixTemp_ + mixTempSize * v, mixTempSize, voiceSamples_ + grainSize * v);
+			}
+		}, 0, activeCount, 2, TaskPriority::HIGH);
+
+		for (int i = 0; i < activeCount; i++) {
+			const int v = active[i];
+			if (voices[v].type == VOICETYPE_ATRAC3)
+				RenderVoice(voices[v], mixTemp_, ARRAY_SIZE(mixTemp_), voiceSamples_ + grainSize * v);
+		}
+	} else {
+		for (int i = 0; i < activeCount; i++) {
+			const int v = active[i];
+			RenderVoice(voices[v], mixTemp_, ARRAY_SIZE(mixTemp_), voiceSamples_ + grainSize * v);
+		}
+	}
+
+	for (int i = 0; i < activeCount; i++) {
+		const int v = active[i];
+		AccumulateVoice(voices[v], voiceSamples_ + grainSize * v);
 	}
 
 	// Then mix the send buffer in with the rest.
@@ -316,7 +316,11 @@ class SasInstance {
 	FILE *audioDump = nullptr;
 
 	void Mix(u32 outAddr, u32 inAddr = 0, int leftVol = 0, int rightVol = 0);
-	void MixVoice(SasVoice &voice);
+	// Resamples and applies the envelope, writing exactly grainSize samples to out.
+	// Touches nothing but the voice and the scratch buffers, so voices can be rendered in parallel.
+	void RenderVoice(SasVoice &voice, int16_t *mixTemp, int mixTempSize, s16 *out);
+	// Applies the voice volumes and adds the rendered samples into mixBuffer and sendBuffer.
+	void AccumulateVoice(const SasVoice &voice, const s16 *samples);
 
 	// Applies reverb to send buffer, according to waveformEffect.
 	void ApplyWaveformEffect();
@@ -334,6 +338,10 @@ class SasInstance {
 	SasReverb reverb_;
 	int grainSize = 0;
 	int16_t mixTemp_[PSP_SAS_MAX_GRAIN * 4 + 2 + 16];  // some extra margin for very high pitches.
+	// grainSize rendered samples per voice, before volumes.
+	s16 *voiceSamples_ = nullptr;
+	// One mixTemp_ sized buffer per voice for parallel mixing, allocated on first use.
+	int16_t *parallelMixTemp_ = nullptr;
 };
 
 const char *ADSRCurveModeAsString(SasADSRCurveMode mode);
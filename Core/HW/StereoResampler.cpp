@@ -31,9 +31,22 @@
 #define MAX_FREQ_SHIFT  600.0f  // how far off can we be from 44100 Hz
 #define CONTROL_FACTOR  0.2f // in freq_shift per fifo size offset
 #define CONTROL_AVG     32.0f
+// in freq_shift per fifo size offset per output sample. A steady offset of 100 samples moves us ~1Hz per second.
+#define CONTROL_INTEGRAL 0.00000025f
+#define MAX_INTEGRAL_SHIFT 300.0f
+
+// With a user chosen latency target, we allow getting much closer to the system buffer size.
+#define TARGET_BUFSIZE_MIN 256
+#define TARGET_BUFSIZE_MIN_MARGIN 128
+
+// Polyphase sinc resampler. Taps are centered so that the output lies between tap 3 and 4.
+#define SINC_TAPS 8
+#define SINC_PHASES 256
+#define SINC_SHIFT 14
 
 #include "ppsspp_config.h"
 #include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <atomic>
 
@@ -42,6 +55,8 @@
 #include "Common/Log.h"
 #include "Common/Math/SIMDHeaders.h"
 #include "Common/Math/CrossSIMD.h"
+#include "Common/Math/math_util.h"
+#include "Common/MemoryUtil.h"
 #include "Common/TimeUtil.h"
 #include "Core/Config.h"
 #include "Core/ConfigValues.h"
@@ -72,6 +87,8 @@ StereoResampler::StereoResampler() noexcept
 StereoResampler::~StereoResampler() {
 	delete[] m_buffer;
 	m_buffer = nullptr;
+	FreeAlignedMemory(sincTable_);
+	FreeAlignedMemory(sincTableSSE_);
 }
 
 void StereoResampler::UpdateBufferSize() {
@@ -82,11 +99,65 @@ void StereoResampler::UpdateBufferSize() {
 		m_maxBufsize = MAX_BUFSIZE_DEFAULT;
 		m_targetBufsize = TARGET_BUFSIZE_DEFAULT;
 
+		int margin = TARGET_BUFSIZE_MARGIN;
+		if (g_Config.iAudioLatencyTargetMs > 0) {
+			// Can be both lower and higher than the default. The rate control keeps us there.
+			m_targetBufsize = std::clamp(g_Config.iAudioLatencyTargetMs * 441 / 10, TARGET_BUFSIZE_MIN, 4096);
+			margin = TARGET_BUFSIZE_MIN_MARGIN;
+		}
+
 		int systemBufsize = System_GetPropertyInt(SYSPROP_AUDIO_FRAMES_PER_BUFFER);
-		if (systemBufsize > 0 && m_targetBufsize < systemBufsize + TARGET_BUFSIZE_MARGIN) {
-			m_targetBufsize = std::min(4096, systemBufsize + TARGET_BUFSIZE_MARGIN);
-			if (m_targetBufsize * 2 > MAX_BUFSIZE_DEFAULT)
-				m_maxBufsize = MAX_BUFSIZE_EXTRA;
+		if (systemBufsize > 0 && m_targetBufsize < systemBufsize + margin) {
+			m_targetBufsize = std::min(4096, systemBufsize + margin);
+		}
+		if (m_targetBufsize * 2 > MAX_BUFSIZE_DEFAULT)
+			m_maxBufsize = MAX_BUFSIZE_EXTRA;
+	}
+}
+
+void StereoResampler::BuildSincTable(int outputSampleRate) {
+	if (!sincTable_) {
+		sincTable_ = (int16_t *)AllocateAlignedMemory(SINC_PHASES * SINC_TAPS * sizeof(int16_t), 16);
+		sincTableSSE_ = (int16_t *)AllocateAlignedMemory(SINC_PHASES * SINC_TAPS * 2 * sizeof(int16_t), 16);
+	}
+	sincTableRate_ = outputSampleRate;
+
+	// When the output rate is lower than ours, we need to cut off below its Nyquist frequency instead.
+	// Either way, leave some room for the transition band, we only have a few taps.
+	const double cutoff = 0.9 * std::min(1.0, (double)outputSampleRate / (double)m_input_sample_rate);
+	const double halfWidth = SINC_TAPS / 2;
+
+	for (int p = 0; p < SINC_PHASES; p++) {
+		const double frac = (double)p / SINC_PHASES;
+		double coefs[SINC_TAPS];
+		double sum = 0.0;
+		for (int k = 0; k < SINC_TAPS; k++) {
+			// Distance from this tap to the output position, in input samples.
+			const double d = (k - (SINC_TAPS / 2 - 1)) - frac;
+			const double x = M_PI * d * cutoff;
+			const double sinc = fabs(x) < 1e-9 ? 1.0 : sin(x) / x;
+			// Blackman window, reaching zero at +/- halfWidth.
+			const double window = 0.42 + 0.5 * cos(M_PI * d / halfWidth) + 0.08 * cos(2.0 * M_PI * d / halfWidth);
+			coefs[k] = sinc * window;
+			sum += coefs[k];
+		}
+
+		// Normalize to unity gain, and put any rounding error on the closest tap so every phase sums exactly to 1.0.
+		int16_t *row = sincTable_ + p * SINC_TAPS;
+		int total = 0;
+		for (int k = 0; k < SINC_TAPS; k++) {
+			row[k] = (int16_t)lround(coefs[k] / sum * (1 << SINC_SHIFT));
+			total += row[k];
+		}
+		row[SINC_TAPS / 2 - 1 + (frac >= 0.5 ? 1 : 0)] += (1 << SINC_SHIFT) - total;
+
+		// c0 c1 c0 c1 c2 c3 c2 c3 | c4 c5 c4 c5 c6 c7 c6 c7, to match L0 L1 R0 R1 L2 L3 R2 R3.
+		int16_t *rowSSE = sincTableSSE_ + p * SINC_TAPS * 2;
+		for (int k = 0; k < SINC_TAPS; k += 2) {
+			rowSSE[k * 2 + 0] = row[k];
+			rowSSE[k * 2 + 1] = row[k + 1];
+			rowSSE[k * 2 + 2] = row[k];
+			rowSSE[k * 2 + 3] = row[k + 1];
 		}
 	}
 }
@@ -147,6 +218,8 @@ inline void ClampBufferToS16WithVolume(s16 *out, const s32 *in, size_t size, int
 
 void StereoResampler::Clear() {
 	memset(m_buffer, 0, m_maxBufsize * 2 * sizeof(int16_t));
+	rateIntegral_ = 0.0f;
+	lastMixUnderran_ = false;
 }
 
 inline int16_t MixSingleSample(int16_t s1, int16_t s2, uint16_t frac) {
@@ -159,6 +232,101 @@ inline int16_t MixSingleSample(int16_t s1, int16_t s2, uint16_t frac) {
 		return (int16_t)value;
 }
 
+unsigned int StereoResampler::ResampleLinear(short *samples, unsigned int numSamples, u32 &indexR, u32 indexW, u32 ratio) {
+	const int INDEX_MASK = (m_maxBufsize * 2 - 1);
+	unsigned int currentSample;
+	u32 frac = m_frac;
+	for (currentSample = 0; currentSample < numSamples * 2; currentSample += 2) {
+		if (((indexW - indexR) & INDEX_MASK) <= 2) {
+			// Ran out!
+			// int missing = numSamples * 2 - currentSample;
+			// ILOG("Resampler underrun: %d (numSamples: %d, currentSample: %d)", missing, numSamples, currentSample / 2);
+			underrunCount_++;
+			break;
+		}
+		u32 indexR2 = indexR + 2; //next sample
+		s16 l1 = m_buffer[indexR & INDEX_MASK]; //current
+		s16 r1 = m_buffer[(indexR + 1) & INDEX_MASK]; //current
+		s16 l2 = m_buffer[indexR2 & INDEX_MASK]; //next
+		s16 r2 = m_buffer[(indexR2 + 1) & INDEX_MASK]; //next
+		samples[currentSample] = MixSingleSample(l1, l2, (u16)frac);
+		samples[currentSample + 1] = MixSingleSample(r1, r2, (u16)frac);
+		frac += ratio;
+		indexR += 2 * (frac >> 16);
+		frac &= 0xffff;
+	}
+	m_frac = frac;
+	return currentSample;
+}
+
+unsigned int StereoResampler::ResampleSinc(short *samples, unsigned int numSamples, u32 &indexR, u32 indexW, u32 ratio) {
+	const int INDEX_MASK = (m_maxBufsize * 2 - 1);
+	// The filter reaches SINC_TAPS / 2 - 1 samples back, and SINC_TAPS / 2 forward.
+	const u32 back = 2 * (SINC_TAPS / 2 - 1);
+	alignas(16) int16_t wrapped[SINC_TAPS * 2];
+
+	unsigned int currentSample;
+	u32 frac = m_frac;
+	for (currentSample = 0; currentSample < numSamples * 2; currentSample += 2) {
+		if (((indexW - indexR) & INDEX_MASK) <= 2 * (SINC_TAPS / 2)) {
+			// Ran out!
+			underrunCount_++;
+			break;
+		}
+
+		const u32 start = (indexR - back) & INDEX_MASK;
+		const int16_t *src = m_buffer + start;
+		if (start + SINC_TAPS * 2 > (u32)INDEX_MASK + 1) {
+			for (int i = 0; i < SINC_TAPS * 2; i++)
+				wrapped[i] = m_buffer[(start + i) & INDEX_MASK];
+			src = wrapped;
+		}
+
+		const int phase = (frac & 0xFFFF) >> 8;
+#ifdef _M_SSE
+		const __m128i *coefs = (const __m128i *)(sincTableSSE_ + phase * SINC_TAPS * 2);
+		__m128i a = _mm_loadu_si128((const __m128i *)src);
+		__m128i b = _mm_loadu_si128((const __m128i *)(src + 8));
+		// L0 R0 L1 R1 L2 R2 L3 R3 -> L0 L1 R0 R1 L2 L3 R2 R3, so that madd keeps the channels apart.
+		a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(a, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+		b = _mm_shufflehi_epi16(_mm_shufflelo_epi16(b, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+		__m128i acc = _mm_add_epi32(_mm_madd_epi16(a, coefs[0]), _mm_madd_epi16(b, coefs[1]));
+		// L R L R -> (L + L) (R + R)
+		acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+		acc = _mm_srai_epi32(_mm_add_epi32(acc, _mm_set1_epi32(1 << (SINC_SHIFT - 1))), SINC_SHIFT);
+		__m128i packed = _mm_packs_epi32(acc, acc);
+		const u32 lr = (u32)_mm_cvtsi128_si32(packed);
+		memcpy(&samples[currentSample], &lr, sizeof(lr));
+#elif PPSSPP_ARCH(ARM_NEON)
+		const int16x8_t coefs = vld1q_s16(sincTable_ + phase * SINC_TAPS);
+		const int16x8x2_t lr = vld2q_s16(src);
+		int32x4_t l = vmull_s16(vget_low_s16(lr.val[0]), vget_low_s16(coefs));
+		l = vmlal_s16(l, vget_high_s16(lr.val[0]), vget_high_s16(coefs));
+		int32x4_t r = vmull_s16(vget_low_s16(lr.val[1]), vget_low_s16(coefs));
+		r = vmlal_s16(r, vget_high_s16(lr.val[1]), vget_high_s16(coefs));
+		int32x2_t sum = vpadd_s32(vpadd_s32(vget_low_s32(l), vget_high_s32(l)), vpadd_s32(vget_low_s32(r), vget_high_s32(r)));
+		int16x4_t packed = vqrshrn_n_s32(vcombine_s32(sum, sum), SINC_SHIFT);
+		vst1_lane_s32((int32_t *)&samples[currentSample], vreinterpret_s32_s16(packed), 0);
+#else
+		const int16_t *coefs = sincTable_ + phase * SINC_TAPS;
+		int l = 0;
+		int r = 0;
+		for (int k = 0; k < SINC_TAPS; k++) {
+			l += src[k * 2] * coefs[k];
+			r += src[k * 2 + 1] * coefs[k];
+		}
+		samples[currentSample] = clamp_s16((l + (1 << (SINC_SHIFT - 1))) >> SINC_SHIFT);
+		samples[currentSample + 1] = clamp_s16((r + (1 << (SINC_SHIFT - 1))) >> SINC_SHIFT);
+#endif
+
+		frac += ratio;
+		indexR += 2 * (frac >> 16);
+		frac &= 0xffff;
+	}
+	m_frac = frac;
+	return currentSample;
+}
+
 // Executed from sound stream thread, pulling sound out of the buffer.
 unsigned int StereoResampler::Mix(short* samples, unsigned int numSamples, bool consider_framelimit, int sample_rate) {
 	if (!samples)
@@ -197,37 +365,36 @@ unsigned int StereoResampler::Mix(short* samples, unsigned int numSamples, bool
 	// Note that the speed of adjustment here does not take the buffer size into
 	// account. Since this is called once per "output frame", the frame size
 	// will affect how fast this algorithm reacts, which can't be a good thing.
-	float offset = (m_numLeftI - (float)m_targetBufsize) * CONTROL_FACTOR;
+	float error = m_numLeftI - (float)m_targetBufsize;
+	// The integral term takes care of any constant drift between the host audio clock and ours,
+	// so the proportional term only needs to handle jitter and we actually settle at the target.
+	// Only with the new options though, and it holds still while we're starved (like when paused)
+	// so it doesn't wind up.
+	if (g_Config.iAudioResampler == AUDIO_RESAMPLER_SINC || g_Config.iAudioLatencyTargetMs > 0) {
+		if (!lastMixUnderran_) {
+			rateIntegral_ += error * CONTROL_INTEGRAL * (float)numSamples;
+			rateIntegral_ = std::clamp(rateIntegral_, -MAX_INTEGRAL_SHIFT, MAX_INTEGRAL_SHIFT);
+		}
+	} else {
+		rateIntegral_ = 0.0f;
+	}
+	float offset = error * CONTROL_FACTOR + rateIntegral_;
 	if (offset > MAX_FREQ_SHIFT) offset = MAX_FREQ_SHIFT;
 	if (offset < -MAX_FREQ_SHIFT) offset = -MAX_FREQ_SHIFT;
 
 	output_sample_rate_ = (float)(m_input_sample_rate + offset);
 	const u32 ratio = (u32)(65536.0 * output_sample_rate_ / (double)sample_rate);
 	ratio_ = ratio;
-	// TODO: consider a higher-quality resampling algorithm.
 	// TODO: Add a fast path for 1:1.
-	u32 frac = m_frac;
-	for (currentSample = 0; currentSample < numSamples * 2; currentSample += 2) {
-		if (((indexW - indexR) & INDEX_MASK) <= 2) {
-			// Ran out!
-			// int missing = numSamples * 2 - currentSample;
-			// ILOG("Resampler underrun: %d (numSamples: %d, currentSample: %d)", missing, numSamples, currentSample / 2);
-			underrunCount_++;
-			break;
-		}
-		u32 indexR2 = indexR + 2; //next sample
-		s16 l1 = m_buffer[indexR & INDEX_MASK]; //current
-		s16 r1 = m_buffer[(indexR + 1) & INDEX_MASK]; //current
-		s16 l2 = m_buffer[indexR2 & INDEX_MASK]; //next
-		s16 r2 = m_buffer[(indexR2 + 1) & INDEX_MASK]; //next
-		samples[currentSample] = MixSingleSample(l1, l2, (u16)frac);
-		samples[currentSample + 1] = MixSingleSample(r1, r2, (u16)frac);
-		frac += ratio;
-		indexR += 2 * (frac >> 16);
-		frac &= 0xffff;
+	if (g_Config.iAudioResampler == AUDIO_RESAMPLER_SINC) {
+		if (sincTableRate_ != sample_rate)
+			BuildSincTable(sample_rate);
+		currentSample = ResampleSinc(samples, numSamples, indexR, indexW, ratio);
+	} else {
+		currentSample = ResampleLinear(samples, numSamples, indexR, indexW, ratio);
 	}
-	m_frac = frac;
 
+	lastMixUnderran_ = currentSample < numSamples * 2;
 	// Let's not count the underrun padding here.
 	outputSampleCount_ += currentSample / 2;
 
@@ -258,7 +425,8 @@ void StereoResampler::PushSamples(const s32 *samples, unsigned int numSamples, f
 	// needs to get updates to not deadlock.
 	u32 indexW = m_indexW.load();
 
-	u32 cap = m_maxBufsize * 2;
+	// Keep a few samples of room behind the read position, the sinc filter looks back at them.
+	u32 cap = m_maxBufsize * 2 - SINC_TAPS * 2;
 	// If fast-forwarding, no need to fill up the entire buffer, just screws up timing after releasing the fast-forward button.
 	if (PSP_CoreParameter().fastForward) {
 		cap = m_targetBufsize * 2;
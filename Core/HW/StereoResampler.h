@@ -46,6 +46,9 @@ class StereoResampler {
 
 private:
 	void UpdateBufferSize();
+	void BuildSincTable(int outputSampleRate);
+	unsigned int ResampleLinear(short *samples, unsigned int numSamples, u32 &indexR, u32 indexW, u32 ratio);
+	unsigned int ResampleSinc(short *samples, unsigned int numSamples, u32 &indexR, u32 indexW, u32 ratio);
 
 	int m_maxBufsize;
 	int m_targetBufsize;
@@ -61,6 +64,16 @@ class StereoResampler {
 	int lastBufSize_ = 0;
 	int lastPushSize_ = 0;
 	u32 ratio_ = 0;
+	// Integral part of the rate control, slowly absorbs constant clock drift between us and the host.
+	float rateIntegral_ = 0.0f;
+	// Whether the last Mix() ran out of samples, the integral doesn't learn from that.
+	bool lastMixUnderran_ = false;
+
+	// Polyphase windowed-sinc filter, SINC_PHASES x SINC_TAPS 2.14 fixed point coefficients.
+	int16_t *sincTable_ = nullptr;
+	// Same coefficients, arranged for _mm_madd_epi16 on shuffled stereo pairs.
+	int16_t *sincTableSSE_ = nullptr;
+	int sincTableRate_ = 0;
 
 	int underrunCount_ = 0;
 	int overrunCount_ = 0;
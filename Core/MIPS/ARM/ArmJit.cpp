@@ -23,6 +23,7 @@
 #include "Common/Log.h"
 #include "Common/Serialize/Serializer.h"
 #include "Common/Serialize/SerializeFuncs.h"
+#include "Common/TimeUtil.h"
 
 #include "Core/Reporting.h"
 #include "Core/Config.h"
@@ -31,6 +32,7 @@
 #include "Core/Debugger/Breakpoints.h"
 #include "Core/Debugger/SymbolMap.h"
 #include "Core/MemMap.h"
+#include "Core/System.h"
 
 #include "Core/MIPS/MIPS.h"
 #include "Core/MIPS/MIPSAnalyst.h"
@@ -243,6 +245,9 @@ void ArmJit::CompileDelaySlot(int flags) {
 
 void ArmJit::Compile(u32 em_address) {
 	PROFILE_THIS_SCOPE("jitc");
+	TimeCollector collectStat(&jitStats.timeCompiling, coreCollectDebugStats);
+	if (coreCollectDebugStats)
+		jitStats.numCompiles++;
 
 	// INFO_LOG(Log::JIT, "Compiling at %08x", em_address);
 
@@ -25,6 +25,7 @@
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Common/CPUDetect.h"
 #include "Common/StringUtils.h"
+#include "Common/TimeUtil.h"
 
 #include "Core/Reporting.h"
 #include "Core/Config.h"
@@ -33,6 +34,7 @@
 #include "Core/Debugger/Breakpoints.h"
 #include "Core/Debugger/SymbolMap.h"
 #include "Core/MemMap.h"
+#include "Core/System.h"
 
 #include "Core/MIPS/MIPS.h"
 #include "Core/MIPS/MIPSAnalyst.h"
@@ -243,6 +245,9 @@ void Arm64Jit::CompileDelaySlot(int flags) {
 
 void Arm64Jit::Compile(u32 em_address) {
 	PROFILE_THIS_SCOPE("jitc");
+	TimeCollector collectStat(&jitStats.timeCompiling, coreCollectDebugStats);
+	if (coreCollectDebugStats)
+		jitStats.numCompiles++;
 	if (GetSpaceLeft() < 0x10000 || blocks.IsFull()) {
 		INFO_LOG(Log::JIT, "Space left: %d", (int)GetSpaceLeft());
 		ClearCache();
@@ -117,6 +117,15 @@ void IRFrontend::CompileDelaySlot() {
 	js.inDelaySlot = false;
 }
 
+u32 IRFrontend::GetCompileFlags() const {
+	u32 flags = 0;
+	if (js.startDefaultPrefix)
+		flags |= 1;
+	if (js.hasSetRounding)
+		flags |= 2;
+	return flags;
+}
+
 bool IRFrontend::CheckRounding(u32 blockAddress) {
 	bool cleanSlate = false;
 	if (js.hasSetRounding && !js.lastSetRounding) {
@@ -239,7 +248,28 @@ MIPSOpcode IRFrontend::GetOffsetInstruction(int offset) {
 	return Memory::Read_Instruction(GetCompilerPC() + 4 * offset);
 }
 
-void IRFrontend::DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload) {
+bool IRFrontend::OptimizeIR(const IRWriter &in, IRWriter &out, const IROptions &opts) {
+	std::vector<IRPassFunc> passes{
+		&ApplyMemoryValidation,
+		&RemoveLoadStoreLeftRight,
+		&OptimizeFPMoves,
+		&PropagateConstants,
+		&PurgeTemps,
+		&ReduceVec4Flush,
+		&OptimizeLoadsAfterStores,
+		// &ReorderLoadStore,
+		// &MergeLoadStore,
+		// &ThreeOpToTwoOp,
+	};
+
+	if (opts.optimizeForInterpreter) {
+		// Add special passes here.
+		passes.push_back(&OptimizeForInterpreter);
+	}
+	return IRApplyPasses(passes.data(), passes.size(), in, out, opts);
+}
+
+void IRFrontend::DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload, std::vector<IRInst> *deferred) {
 	js.cancel = false;
 	js.preloading = preload;
 	js.blockStart = em_address;
@@ -278,25 +308,14 @@ void IRFrontend::DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &m
 	IRWriter simplified;
 	IRWriter *code = &ir;
 	if (!js.hadBreakpoints) {
-		std::vector<IRPassFunc> passes{
-			&ApplyMemoryValidation,
-			&RemoveLoadStoreLeftRight,
-			&OptimizeFPMoves,
-			&PropagateConstants,
-			&PurgeTemps,
-			&ReduceVec4Flush,
-			&OptimizeLoadsAfterStores,
-			// &ReorderLoadStore,
-			// &MergeLoadStore,
-			// &ThreeOpToTwoOp,
-		};
-
-		if (opts.optimizeForInterpreter) {
-			// Add special passes here.
-			passes.push_back(&OptimizeForInterpreter);
-		}
-		if (IRApplyPasses(passes.data(), passes.size(), ir, simplified, opts))
+		if (deferred) {
+			// Memory validation can't wait, the rest is just for speed.
+			IRPassFunc pass = &ApplyMemoryValidation;
+			IRApplyPasses(&pass, 1, ir, simplified, opts);
+			*deferred = ir.GetInstructions();
+		} else if (OptimizeIR(ir, simplified, opts)) {
 			logBlocks = 1;
+		}
 		code = &simplified;
 		//if (ir.GetInstructions().size() >= 24)
 		//	logBlocks = 1;
@@ -89,7 +89,11 @@ class IRFrontend : public MIPSFrontendInterface {
 	void DoState(PointerWrap &p);
 	bool CheckRounding(u32 blockAddress);  // returns true if we need a do-over
 
-	void DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload);
+	// If deferred is set, only the passes needed for correctness are applied to instructions,
+	// and the raw IR is returned in deferred so OptimizeIR() can be run on it later.
+	void DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload, std::vector<IRInst> *deferred = nullptr);
+	// Runs the full simplify pipeline. Doesn't touch frontend state, so it's safe on any thread.
+	static bool OptimizeIR(const IRWriter &in, IRWriter &out, const IROptions &opts);
 
 	void EatPrefix() override {
 		js.EatPrefix();
@@ -98,6 +102,12 @@ class IRFrontend : public MIPSFrontendInterface {
 	void SetOptions(const IROptions &o) {
 		opts = o;
 	}
+	const IROptions &GetOptions() const {
+		return opts;
+	}
+
+	// State that affects the generated IR beyond the options, used to key cached blocks.
+	u32 GetCompileFlags() const;
 
 private:
 	void RestoreRoundingMode(bool force = false);
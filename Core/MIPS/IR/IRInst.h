@@ -242,6 +242,10 @@ enum class IROp : uint8_t {
 
 	Nop,
 	Bad,
+
+	// Between the blocks of a trace, leaves if it's time to run CoreTiming events.  IR interpreter only.
+	// Added last so the numbering of the others, and the IR disk cache, stay the same.
+	ExitToConstIfDowncountLtZ,  // const
 };
 
 enum IRComparison {
@@ -28,6 +28,36 @@
 #define mips mips
 #endif
 
+// With GCC/clang, the common ops are dispatched with computed gotos ("direct threading"):
+// each handler jumps straight to the next op's handler, so the indirect branches are spread
+// out and predicted per op, rather than all sharing the single jump at the top of the switch.
+// Anything not in this list just goes back through the switch.
+#if defined(__GNUC__) && !defined(_DEBUG)
+#define IR_THREADED_DISPATCH 1
+#endif
+
+#define IR_THREADED_OPS(X) \
+	X(SetConst) X(SetConstF) X(Add) X(Sub) X(And) X(Or) \
+	X(Xor) X(Mov) X(AddConst) X(OptAddConst) X(SubConst) X(AndConst) \
+	X(OptAndConst) X(OrConst) X(OptOrConst) X(XorConst) X(Neg) X(Not) \
+	X(Ext8to32) X(Ext16to32) X(Load8) X(Load8Ext) X(Load16) X(Load16Ext) \
+	X(Load32) X(LoadFloat) X(Store8) X(Store16) X(Store32) X(StoreFloat) \
+	X(LoadVec4) X(StoreVec4) X(Vec4Mov) X(ShlImm) X(ShrImm) X(SarImm) \
+	X(RorImm) X(Shl) X(Shr) X(Sar) X(Ror) X(Slt) \
+	X(SltU) X(SltConst) X(SltUConst) X(MovZ) X(MovNZ) X(MfLo) \
+	X(MfHi) X(Mult) X(MultU) X(FAdd) X(FSub) X(FMul) \
+	X(FDiv) X(FMov) X(FAbs) X(FNeg) X(FMovFromGPR) X(FMovToGPR) \
+	X(ExitToConst) X(ExitToReg) X(ExitToConstIfEq) X(ExitToConstIfNeq) X(ExitToConstIfGtZ) X(ExitToConstIfGeZ) \
+	X(ExitToConstIfLtZ) X(ExitToConstIfLeZ) X(Downcount) X(SetPCConst)
+
+#ifdef IR_THREADED_DISPATCH
+#define IR_CASE(op) case IROp::op: ir_##op
+#define IR_NEXT { ++inst; goto *dispatchTable[(int)inst->op]; }
+#else
+#define IR_CASE(op) case IROp::op
+#define IR_NEXT break
+#endif
+
 alignas(16) static const float vec4InitValues[8][4] = {
 	{ 0.0f, 0.0f, 0.0f, 0.0f },
 	{ 1.0f, 1.0f, 1.0f, 1.0f },
@@ -138,87 +168,103 @@ void IRRestoreRounding() {
 
 // We cannot use NEON on ARM32 here until we make it a hard dependency. We can, however, on ARM64.
 u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
+#ifdef IR_THREADED_DISPATCH
+	static const void *dispatchTable[256];
+	static bool dispatchTableReady = false;
+	if (!dispatchTableReady) {
+		for (int i = 0; i < 256; ++i)
+			dispatchTable[i] = &&ir_switch;
+#define IR_DISPATCH_ENTRY(op) dispatchTable[(int)IROp::op] = &&ir_##op;
+		IR_THREADED_OPS(IR_DISPATCH_ENTRY)
+#undef IR_DISPATCH_ENTRY
+		dispatchTableReady = true;
+	}
+#endif
+
 	while (true) {
+#ifdef IR_THREADED_DISPATCH
+ir_switch:
+#endif
 		switch (inst->op) {
-		case IROp::SetConst:
+		IR_CASE(SetConst):
 			mips->r[inst->dest] = inst->constant;
-			break;
-		case IROp::SetConstF:
+			IR_NEXT;
+		IR_CASE(SetConstF):
 			memcpy(&mips->f[inst->dest], &inst->constant, 4);
-			break;
-		case IROp::Add:
+			IR_NEXT;
+		IR_CASE(Add):
 			mips->r[inst->dest] = mips->r[inst->src1] + mips->r[inst->src2];
-			break;
-		case IROp::Sub:
+			IR_NEXT;
+		IR_CASE(Sub):
 			mips->r[inst->dest] = mips->r[inst->src1] - mips->r[inst->src2];
-			break;
-		case IROp::And:
+			IR_NEXT;
+		IR_CASE(And):
 			mips->r[inst->dest] = mips->r[inst->src1] & mips->r[inst->src2];
-			break;
-		case IROp::Or:
+			IR_NEXT;
+		IR_CASE(Or):
 			mips->r[inst->dest] = mips->r[inst->src1] | mips->r[inst->src2];
-			break;
-		case IROp::Xor:
+			IR_NEXT;
+		IR_CASE(Xor):
 			mips->r[inst->dest] = mips->r[inst->src1] ^ mips->r[inst->src2];
-			break;
-		case IROp::Mov:
+			IR_NEXT;
+		IR_CASE(Mov):
 			mips->r[inst->dest] = mips->r[inst->src1];
-			break;
-		case IROp::AddConst:
+			IR_NEXT;
+		IR_CASE(AddConst):
 			mips->r[inst->dest] = mips->r[inst->src1] + inst->constant;
-			break;
-		case IROp::OptAddConst:  // For this one, it's worth having a "unary" variant of the above that only needs to read one register param.
+			IR_NEXT;
+		IR_CASE(OptAddConst):  // For this one, it's worth having a "unary" variant of the above that only needs to read one register param.
 			mips->r[inst->dest] += inst->constant;
-			break;
-		case IROp::SubConst:
+			IR_NEXT;
+		IR_CASE(SubConst):
 			mips->r[inst->dest] = mips->r[inst->src1] - inst->constant;
-			break;
-		case IROp::AndConst:
+			IR_NEXT;
+		IR_CASE(AndConst):
 			mips->r[inst->dest] = mips->r[inst->src1] & inst->constant;
-			break;
-		case IROp::OptAndConst:  // For this one, it's worth having a "unary" variant of the above that only needs to read one register param.
+			IR_NEXT;
+		IR_CASE(OptAndConst):  // For this one, it's worth having a "unary" variant of the above that only needs to read one register param.
 			mips->r[inst->dest] &= inst->constant;
-			break;
-		case IROp::OrConst:
+			IR_NEXT;
+		IR_CASE(OrConst):
 			mips->r[inst->dest] = mips->r[inst->src1] | inst->constant;
-			break;
-		case IROp::OptOrConst:
+			IR_NEXT;
+		IR_CASE(OptOrConst):
 			mips->r[inst->dest] |= inst->constant;
-			break;
-		case IROp::XorConst:
+			IR_NEXT;
+		IR_CASE(XorConst):
 			mips->r[inst->dest] = mips->r[inst->src1] ^ inst->constant;
-			break;
-		case IROp::Neg:
+			IR_NEXT;
+		IR_CASE(Neg):
 			mips->r[inst->dest] = (u32)(-(s32)mips->r[inst->src1]);
-			break;
-		case IROp::Not:
+			IR_NEXT;
+		IR_CASE(Not):
 			mips->r[inst->dest] = ~mips->r[inst->src1];
-			break;
-		case IROp::Ext8to32:
+			IR_NEXT;
+		IR_CASE(Ext8to32):
 			mips->r[inst->dest] = SignExtend8ToU32(mips->r[inst->src1]);
-			break;
-		case IROp::Ext16to32:
+			IR_NEXT;
+		IR_CASE(Ext16to32):
 			mips->r[inst->dest] = SignExtend16ToU32(mips->r[inst->src1]);
-			break;
+			IR_NEXT;
 		case IROp::ReverseBits:
 			mips->r[inst->dest] = ReverseBits32(mips->r[inst->src1]);
 			break;
 
-		case IROp::Load8:
+		IR_CASE(Load8):
 			mips->r[inst->dest] = Memory::ReadUnchecked_U8(mips->r[inst->src1] + inst->constant);
-			break;
-		case IROp::Load8Ext:
+			IR_NEXT;
+		IR_CASE(Load8Ext):
 			mips->r[inst->dest] = SignExtend8ToU32(Memory::ReadUnchecked_U8(mips->r[inst->src1] + inst->constant));
-			break;
-		case IROp::Load16:
+			IR_NEXT;
+		IR_CASE(Load16):
 			mips->r[inst->dest] = Memory::ReadUnchecked_U16(mips->r[inst->src1] + inst->constant);
-			break;
-		case IROp::Load16Ext:
+			IR_NEXT;
+		IR_CASE(Load16Ext):
 			mips->r[inst->dest] = SignExtend16ToU32(Memory::ReadUnchecked_U16(mips->r[inst->src1] + inst->constant));
-			break;
-		case IROp::Load32:
+			IR_NEXT;
+		IR_CASE(Load32):
 			mips->r[inst->dest] = Memory::ReadUnchecked_U32(mips->r[inst->src1] + inst->constant);
-			break;
+			IR_NEXT;
 		case IROp::Load32Left:
 		{
 			u32 addr = mips->r[inst->src1] + inst->constant;
@@ -242,19 +288,19 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 				mips->r[inst->dest] = Memory::ReadUnchecked_U32(mips->r[inst->src1] + inst->constant);
 			mips->llBit = 1;
 			break;
-		case IROp::LoadFloat:
+		IR_CASE(LoadFloat):
 			mips->f[inst->dest] = Memory::ReadUnchecked_Float(mips->r[inst->src1] + inst->constant);
-			break;
+			IR_NEXT;
 
-		case IROp::Store8:
+		IR_CASE(Store8):
 			Memory::WriteUnchecked_U8(mips->r[inst->src3], mips->r[inst->src1] + inst->constant);
-			break;
-		case IROp::Store16:
+			IR_NEXT;
+		IR_CASE(Store16):
 			Memory::WriteUnchecked_U16(mips->r[inst->src3], mips->r[inst->src1] + inst->constant);
-			break;
-		case IROp::Store32:
+			IR_NEXT;
+		IR_CASE(Store32):
 			Memory::WriteUnchecked_U32(mips->r[inst->src3], mips->r[inst->src1] + inst->constant);
-			break;
+			IR_NEXT;
 		case IROp::Store32Left:
 		{
 			u32 addr = mips->r[inst->src1] + inst->constant;
@@ -285,22 +331,22 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 				mips->r[inst->dest] = 0;
 			}
 			break;
-		case IROp::StoreFloat:
+		IR_CASE(StoreFloat):
 			Memory::WriteUnchecked_Float(mips->f[inst->src3], mips->r[inst->src1] + inst->constant);
-			break;
+			IR_NEXT;
 
-		case IROp::LoadVec4:
+		IR_CASE(LoadVec4):
 		{
 			u32 base = mips->r[inst->src1] + inst->constant;
 			// This compiles to a nice SSE load/store on x86, and hopefully similar on ARM.
 			memcpy(&mips->f[inst->dest], Memory::GetPointerUnchecked(base), 4 * 4);
-			break;
+			IR_NEXT;
 		}
-		case IROp::StoreVec4:
+		IR_CASE(StoreVec4):
 		{
 			u32 base = mips->r[inst->src1] + inst->constant;
 			memcpy((float *)Memory::GetPointerUnchecked(base), &mips->f[inst->dest], 4 * 4);
-			break;
+			IR_NEXT;
 		}
 
 		case IROp::Vec4Init:
@@ -335,7 +381,7 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 			break;
 		}
 
-		case IROp::Vec4Mov:
+		IR_CASE(Vec4Mov):
 		{
 #if defined(_M_SSE)
 			_mm_store_ps(&mips->f[inst->dest], _mm_load_ps(&mips->f[inst->src1]));
@@ -344,7 +390,7 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 #else
 			memcpy(&mips->f[inst->dest], &mips->f[inst->src1], 4 * sizeof(float));
 #endif
-			break;
+			IR_NEXT;
 		}
 
 		case IROp::Vec4Add:
@@ -649,38 +695,38 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 			mips->f[inst->dest] = vfpu_asin(mips->f[inst->src1]);
 			break;
 
-		case IROp::ShlImm:
+		IR_CASE(ShlImm):
 			mips->r[inst->dest] = mips->r[inst->src1] << (int)inst->src2;
-			break;
-		case IROp::ShrImm:
+			IR_NEXT;
+		IR_CASE(ShrImm):
 			mips->r[inst->dest] = mips->r[inst->src1] >> (int)inst->src2;
-			break;
-		case IROp::SarImm:
+			IR_NEXT;
+		IR_CASE(SarImm):
 			mips->r[inst->dest] = (s32)mips->r[inst->src1] >> (int)inst->src2;
-			break;
-		case IROp::RorImm:
+			IR_NEXT;
+		IR_CASE(RorImm):
 		{
 			u32 x = mips->r[inst->src1];
 			int sa = inst->src2;
 			mips->r[inst->dest] = (x >> sa) | (x << (32 - sa));
 		}
-		break;
+		IR_NEXT;
 
-		case IROp::Shl:
+		IR_CASE(Shl):
 			mips->r[inst->dest] = mips->r[inst->src1] << (mips->r[inst->src2] & 31);
-			break;
-		case IROp::Shr:
+			IR_NEXT;
+		IR_CASE(Shr):
 			mips->r[inst->dest] = mips->r[inst->src1] >> (mips->r[inst->src2] & 31);
-			break;
-		case IROp::Sar:
+			IR_NEXT;
+		IR_CASE(Sar):
 			mips->r[inst->dest] = (s32)mips->r[inst->src1] >> (mips->r[inst->src2] & 31);
-			break;
-		case IROp::Ror:
+			IR_NEXT;
+		IR_CASE(Ror):
 		{
 			u32 x = mips->r[inst->src1];
 			int sa = mips->r[inst->src2] & 31;
 			mips->r[inst->dest] = (x >> sa) | (x << (32 - sa));
-			break;
+			IR_NEXT;
 		}
 
 		case IROp::Clz:
@@ -689,30 +735,30 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 			break;
 		}
 
-		case IROp::Slt:
+		IR_CASE(Slt):
 			mips->r[inst->dest] = (s32)mips->r[inst->src1] < (s32)mips->r[inst->src2];
-			break;
+			IR_NEXT;
 
-		case IROp::SltU:
+		IR_CASE(SltU):
 			mips->r[inst->dest] = mips->r[inst->src1] < mips->r[inst->src2];
-			break;
+			IR_NEXT;
 
-		case IROp::SltConst:
+		IR_CASE(SltConst):
 			mips->r[inst->dest] = (s32)mips->r[inst->src1] < (s32)inst->constant;
-			break;
+			IR_NEXT;
 
-		case IROp::SltUConst:
+		IR_CASE(SltUConst):
 			mips->r[inst->dest] = mips->r[inst->src1] < inst->constant;
-			break;
+			IR_NEXT;
 
-		case IROp::MovZ:
+		IR_CASE(MovZ):
 			if (mips->r[inst->src1] == 0)
 				mips->r[inst->dest] = mips->r[inst->src2];
-			break;
-		case IROp::MovNZ:
+			IR_NEXT;
+		IR_CASE(MovNZ):
 			if (mips->r[inst->src1] != 0)
 				mips->r[inst->dest] = mips->r[inst->src2];
-			break;
+			IR_NEXT;
 
 		case IROp::Max:
 			mips->r[inst->dest] = (s32)mips->r[inst->src1] > (s32)mips->r[inst->src2] ? mips->r[inst->src1] : mips->r[inst->src2];
@@ -727,24 +773,24 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 		case IROp::MtHi:
 			mips->hi = mips->r[inst->src1];
 			break;
-		case IROp::MfLo:
+		IR_CASE(MfLo):
 			mips->r[inst->dest] = mips->lo;
-			break;
-		case IROp::MfHi:
+			IR_NEXT;
+		IR_CASE(MfHi):
 			mips->r[inst->dest] = mips->hi;
-			break;
+			IR_NEXT;
 
-		case IROp::Mult:
+		IR_CASE(Mult):
 		{
 			s64 result = (s64)(s32)mips->r[inst->src1] * (s64)(s32)mips->r[inst->src2];
 			memcpy(&mips->lo, &result, 8);
-			break;
+			IR_NEXT;
 		}
-		case IROp::MultU:
+		IR_CASE(MultU):
 		{
 			u64 result = (u64)mips->r[inst->src1] * (u64)mips->r[inst->src2];
 			memcpy(&mips->lo, &result, 8);
-			break;
+			IR_NEXT;
 		}
 		case IROp::Madd:
 		{
@@ -822,13 +868,13 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 			break;
 		}
 
-		case IROp::FAdd:
+		IR_CASE(FAdd):
 			mips->f[inst->dest] = mips->f[inst->src1] + mips->f[inst->src2];
-			break;
-		case IROp::FSub:
+			IR_NEXT;
+		IR_CASE(FSub):
 			mips->f[inst->dest] = mips->f[inst->src1] - mips->f[inst->src2];
-			break;
-		case IROp::FMul:
+			IR_NEXT;
+		IR_CASE(FMul):
 #if 1
 		{
 			float a = mips->f[inst->src1];
@@ -839,7 +885,7 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 				mips->f[inst->dest] = a * b;
 			}
 		}
-			break;
+			IR_NEXT;
 #else
 			// Not sure if faster since it needs to load the operands twice? But the code is simpler.
 			{
@@ -851,12 +897,12 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 				} else {
 					mips->f[inst->dest] = mips->f[inst->src1] * mips->f[inst->src2];
 				}
-				break;
+				IR_NEXT;
 			}
 #endif
-		case IROp::FDiv:
+		IR_CASE(FDiv):
 			mips->f[inst->dest] = mips->f[inst->src1] / mips->f[inst->src2];
-			break;
+			IR_NEXT;
 		case IROp::FMin:
 			if (my_isnan(mips->f[inst->src1]) || my_isnan(mips->f[inst->src2])) {
 				// See interpreter for this logic: this is for vmin, we're comparing mantissa+exp.
@@ -882,18 +928,18 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 			}
 			break;
 
-		case IROp::FMov:
+		IR_CASE(FMov):
 			mips->f[inst->dest] = mips->f[inst->src1];
-			break;
-		case IROp::FAbs:
+			IR_NEXT;
+		IR_CASE(FAbs):
 			mips->f[inst->dest] = fabsf(mips->f[inst->src1]);
-			break;
+			IR_NEXT;
 		case IROp::FSqrt:
 			mips->f[inst->dest] = sqrtf(mips->f[inst->src1]);
 			break;
-		case IROp::FNeg:
+		IR_CASE(FNeg):
 			mips->f[inst->dest] = -mips->f[inst->src1];
-			break;
+			IR_NEXT;
 		case IROp::FSat0_1:
 			// We have to do this carefully to handle NAN and -0.0f.
 			mips->f[inst->dest] = vfpu_clamp(mips->f[inst->src1], 0.0f, 1.0f);
@@ -1071,15 +1117,15 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 			break;
 		}
 
-		case IROp::FMovFromGPR:
+		IR_CASE(FMovFromGPR):
 			memcpy(&mips->f[inst->dest], &mips->r[inst->src1], 4);
-			break;
+			IR_NEXT;
 		case IROp::OptFCvtSWFromGPR:
 			mips->f[inst->dest] = (float)(int)mips->r[inst->src1];
 			break;
-		case IROp::FMovToGPR:
+		IR_CASE(FMovToGPR):
 			memcpy(&mips->r[inst->dest], &mips->f[inst->src1], 4);
-			break;
+			IR_NEXT;
 		case IROp::OptFMovToGPRShr8:
 		{
 			u32 temp;
@@ -1088,48 +1134,48 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 			break;
 		}
 
-		case IROp::ExitToConst:
+		IR_CASE(ExitToConst):
 			return inst->constant;
 
-		case IROp::ExitToReg:
+		IR_CASE(ExitToReg):
 			return mips->r[inst->src1];
 
-		case IROp::ExitToConstIfEq:
+		IR_CASE(ExitToConstIfEq):
 			if (mips->r[inst->src1] == mips->r[inst->src2])
 				return inst->constant;
-			break;
-		case IROp::ExitToConstIfNeq:
+			IR_NEXT;
+		IR_CASE(ExitToConstIfNeq):
 			if (mips->r[inst->src1] != mips->r[inst->src2])
 				return inst->constant;
-			break;
-		case IROp::ExitToConstIfGtZ:
+			IR_NEXT;
+		IR_CASE(ExitToConstIfGtZ):
 			if ((s32)mips->r[inst->src1] > 0)
 				return inst->constant;
-			break;
-		case IROp::ExitToConstIfGeZ:
+			IR_NEXT;
+		IR_CASE(ExitToConstIfGeZ):
 			if ((s32)mips->r[inst->src1] >= 0)
 				return inst->constant;
-			break;
-		case IROp::ExitToConstIfLtZ:
+			IR_NEXT;
+		IR_CASE(ExitToConstIfLtZ):
 			if ((s32)mips->r[inst->src1] < 0)
 				return inst->constant;
-			break;
-		case IROp::ExitToConstIfLeZ:
+			IR_NEXT;
+		IR_CASE(ExitToConstIfLeZ):
 			if ((s32)mips->r[inst->src1] <= 0)
 				return inst->constant;
-			break;
+			IR_NEXT;
 
-		case IROp::Downcount:
+		IR_CASE(Downcount):
 			mips->downcount -= (int)inst->constant;
-			break;
+			IR_NEXT;
 
 		case IROp::SetPC:
 			mips->pc = mips->r[inst->src1];
 			break;
 
-		case IROp::SetPCConst:
+		IR_CASE(SetPCConst):
 			mips->pc = inst->constant;
-			break;
+			IR_NEXT;
 
 		case IROp::Syscall:
 			// IROp::SetPC was (hopefully) executed before.
@@ -1144,6 +1190,11 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst) {
 		case IROp::ExitToPC:
 			return mips->pc;
 
+		case IROp::ExitToConstIfDowncountLtZ:
+			if (mips->downcount < 0)
+				return inst->constant;
+			break;
+
 		case IROp::Interpret:  // SLOW fallback. Can be made faster. Ideally should be removed but may be useful for debugging.
 		{
 			MIPSOpcode op(inst->constant);
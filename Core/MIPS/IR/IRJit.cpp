@@ -22,13 +22,19 @@
 #include "ext/xxhash.h"
 #include "Common/Profiler/Profiler.h"
 
+#include "Common/File/FileUtil.h"
 #include "Common/Log.h"
+#include "Common/Thread/Promise.h"
+#include "Common/Thread/ThreadManager.h"
 #include "Common/Serialize/Serializer.h"
 #include "Common/StringUtils.h"
 
 #include "Core/Config.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
+#include "Core/System.h"
+#include "Core/Debugger/Breakpoints.h"
+#include "Core/ELF/ParamSFO.h"
 #include "Core/HLE/sceKernelMemory.h"
 #include "Core/MemMap.h"
 #include "Core/MIPS/MIPS.h"
@@ -75,9 +81,31 @@ IRJit::IRJit(MIPSState *mipsState, bool actualJit) : frontend_(mipsState->HasDef
 #endif
 	opts.optimizeForInterpreter = jo.optimizeForInterpreter;
 	frontend_.SetOptions(opts);
+
+	std::string discID = g_paramSFO.GetDiscID();
+	if (g_Config.bIRDiskCache && !discID.empty()) {
+		File::CreateFullPath(GetSysDirectory(DIRECTORY_APP_CACHE));
+		// The interpreter and the JITs produce different IR, so keep them apart.
+		diskCachePath_ = GetSysDirectory(DIRECTORY_APP_CACHE) / (discID + (actualJit ? ".irjitcache" : ".ircache"));
+		useDiskCache_ = true;
+		blocks_.LoadDiskCache(diskCachePath_, opts);
+	}
+
+	// The native backends emit code on the emu thread, so there's nothing to gain there.
+	backgroundCompile_ = g_Config.bIRBackgroundCompile && !actualJit;
+	// Profiling happens in our dispatcher, which the native backends don't use.
+	traceFormation_ = g_Config.bIRTraceFormation && !actualJit;
+	for (TraceLookup &lookup : traceLookup_) {
+		lookup.offset = 0xFFFFFFFF;
+		lookup.blockNum = -1;
+	}
 }
 
 IRJit::~IRJit() {
+	WaitForBackgroundTasks();
+	if (useDiskCache_) {
+		blocks_.SaveDiskCache(diskCachePath_, frontend_.GetOptions());
+	}
 }
 
 void IRJit::DoState(PointerWrap &p) {
@@ -89,6 +117,20 @@ void IRJit::UpdateFCR31() {
 
 void IRJit::ClearCache() {
 	INFO_LOG(Log::JIT, "IRJit: Clearing the block cache!");
+	if (backgroundCompile_) {
+		// Anything still in flight refers to blocks that are about to be gone.
+		std::lock_guard<std::mutex> guard(bgLock_);
+		bgGeneration_++;
+		bgResults_.clear();
+		bgResultsReady_ = false;
+	}
+	if (traceFormation_) {
+		traceProfiles_.clear();
+		for (TraceLookup &lookup : traceLookup_) {
+			lookup.offset = 0xFFFFFFFF;
+			lookup.blockNum = -1;
+		}
+	}
 	blocks_.Clear();
 }
 
@@ -115,6 +157,9 @@ void IRJit::Compile(u32 em_address) {
 	_dbg_assert_(compilerEnabled_);
 
 	PROFILE_THIS_SCOPE("jitc");
+	TimeCollector collectStat(&jitStats.timeCompiling, coreCollectDebugStats);
+	if (coreCollectDebugStats)
+		jitStats.numCompiles++;
 
 	if (g_Config.bPreloadFunctions) {
 		// Look to see if we've preloaded this block.
@@ -152,7 +197,17 @@ void IRJit::Compile(u32 em_address) {
 bool IRJit::CompileBlock(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload) {
 	_dbg_assert_(compilerEnabled_);
 
-	frontend_.DoJit(em_address, instructions, mipsBytes, preload);
+	// The IR depends on the flags going in, DoJit may change them for later blocks.
+	const u32 compileFlags = frontend_.GetCompileFlags();
+	bool cached = false;
+	if (useDiskCache_ && !mipsTracer.tracing_enabled && !g_breakpoints.HasBreakPoints() && !g_breakpoints.HasMemChecks()) {
+		cached = blocks_.FindDiskCachedBlock(em_address, compileFlags, instructions, mipsBytes);
+	}
+	std::vector<IRInst> deferred;
+	bool defer = backgroundCompile_ && !cached && !preload && !mipsTracer.tracing_enabled;
+	if (!cached) {
+		frontend_.DoJit(em_address, instructions, mipsBytes, preload, defer ? &deferred : nullptr);
+	}
 	if (instructions.empty()) {
 		_dbg_assert_(preload);
 		// We return true when preloading so it doesn't abort.
@@ -167,8 +222,12 @@ bool IRJit::CompileBlock(u32 em_address, std::vector<IRInst> &instructions, u32
 	}
 
 	IRBlock *b = blocks_.GetBlock(block_num);
-	if (preload || mipsTracer.tracing_enabled) {
+	b->SetCompileFlags(compileFlags);
+	// Deferred blocks still run unoptimized IR until the background result is swapped in.
+	b->SetDiskCacheable(deferred.empty());
+	if (preload || mipsTracer.tracing_enabled || useDiskCache_ || !deferred.empty()) {
 		// Hash, then only update page stats, don't link yet.
+		// The disk cache needs the hash too, and it has to be taken before the emuhack is written.
 		// TODO: Should we always hash?  Then we can reuse blocks.
 		b->UpdateHash();
 	}
@@ -184,9 +243,309 @@ bool IRJit::CompileBlock(u32 em_address, std::vector<IRInst> &instructions, u32
 	blocks_.FinalizeBlock(block_num, preload);
 	if (!preload)
 		FinalizeNativeBlock(&blocks_, block_num);
+
+	if (!deferred.empty())
+		QueueBackgroundOptimize(block_num, std::move(deferred));
+	return true;
+}
+
+void IRJit::QueueBackgroundOptimize(int block_num, std::vector<IRInst> &&unoptimized) {
+	const IRBlock *block = blocks_.GetBlock(block_num);
+	BackgroundResult job{};
+	job.em_address = block->GetOriginalStart();
+	job.hash = block->GetHash();
+
+	{
+		std::lock_guard<std::mutex> guard(bgLock_);
+		job.generation = bgGeneration_;
+		bgPending_++;
+	}
+
+	IROptions opts = frontend_.GetOptions();
+	auto task = [this, opts, job = std::move(job), unoptimized = std::move(unoptimized)]() mutable {
+		IRWriter in, out;
+		in.Reserve(unoptimized.size());
+		for (const IRInst &inst : unoptimized)
+			in.Write(inst);
+		IRFrontend::OptimizeIR(in, out, opts);
+		job.instructions = out.GetInstructions();
+
+		std::lock_guard<std::mutex> guard(bgLock_);
+		if (job.generation == bgGeneration_) {
+			bgResults_.push_back(std::move(job));
+			bgResultsReady_ = true;
+		}
+		bgPending_--;
+		bgCond_.notify_all();
+	};
+	g_threadManager.EnqueueTask(new IndependentTask<decltype(task)>(TaskType::CPU_COMPUTE, TaskPriority::LOW, std::move(task)));
+}
+
+void IRJit::InstallBackgroundResults() {
+	std::vector<BackgroundResult> results;
+	{
+		std::lock_guard<std::mutex> guard(bgLock_);
+		results = std::move(bgResults_);
+		bgResults_.clear();
+		bgResultsReady_ = false;
+	}
+
+	// We're between blocks here, so nothing is executing the old IR.
+	for (const BackgroundResult &result : results) {
+		int block_num = blocks_.GetBlockNumberFromStartAddress(result.em_address);
+		const IRBlock *block = blocks_.GetBlock(block_num);
+		// If the block was invalidated or recompiled meanwhile, drop the result.
+		if (!block || !block->IsValid() || block->GetHash() != result.hash || result.instructions.empty())
+			continue;
+
+		u32 start, size;
+		block->GetRange(&start, &size);
+		// If the arena is full, we just keep running the unoptimized version until the next clear.
+		int new_num = ReplaceBlock(block_num, size, result.instructions);
+		if (new_num >= 0)
+			blocks_.GetBlockUnchecked(new_num)->SetDiskCacheable(true);
+	}
+}
+
+int IRJit::ReplaceBlock(int block_num, u32 mipsBytes, const std::vector<IRInst> &instructions) {
+	_dbg_assert_(!compileToNative_);
+
+	u32 start = blocks_.GetBlock(block_num)->GetOriginalStart();
+	int new_num = blocks_.AllocateBlock(start, mipsBytes, instructions);
+	if ((new_num & ~MIPS_EMUHACK_VALUE_MASK) != 0)
+		return -1;
+
+	// AllocateBlock may have moved the blocks around.
+	IRBlock *block = blocks_.GetBlockUnchecked(block_num);
+	const u32 compileFlags = block->GetCompileFlags();
+	blocks_.RemoveBlockFromPageLookup(block_num);
+	block->Destroy(block->GetIRArenaOffset());
+
+	// Callers decide whether the new IR is fit for the disk cache.
+	IRBlock *newBlock = blocks_.GetBlockUnchecked(new_num);
+	newBlock->SetCompileFlags(compileFlags);
+	newBlock->UpdateHash();
+	blocks_.FinalizeBlock(new_num, false);
+	return new_num;
+}
+
+// How many times a block has to run before we decide whether to build a trace from it.
+static const u32 TRACE_HOT_EXECUTIONS = 1000;
+// Limits, so traces stay small enough that invalidation by range doesn't get too coarse.
+static const int TRACE_MAX_BLOCKS = 4;
+static const u32 TRACE_MAX_BYTES = 0x800;
+static const size_t TRACE_MAX_INSTRUCTIONS = 1024;
+
+static bool IsHotRatio(u32 taken, u32 total) {
+	return total != 0 && taken * 4 >= total * 3;
+}
+
+static bool IsConditionalConstExit(IROp op) {
+	switch (op) {
+	case IROp::ExitToConstIfEq:
+	case IROp::ExitToConstIfNeq:
+	case IROp::ExitToConstIfGtZ:
+	case IROp::ExitToConstIfGeZ:
+	case IROp::ExitToConstIfLtZ:
+	case IROp::ExitToConstIfLeZ:
+	case IROp::ExitToConstIfFpTrue:
+	case IROp::ExitToConstIfFpFalse:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static IROp InvertConditionalExit(IROp op) {
+	switch (op) {
+	case IROp::ExitToConstIfEq: return IROp::ExitToConstIfNeq;
+	case IROp::ExitToConstIfNeq: return IROp::ExitToConstIfEq;
+	case IROp::ExitToConstIfGtZ: return IROp::ExitToConstIfLeZ;
+	case IROp::ExitToConstIfGeZ: return IROp::ExitToConstIfLtZ;
+	case IROp::ExitToConstIfLtZ: return IROp::ExitToConstIfGeZ;
+	case IROp::ExitToConstIfLeZ: return IROp::ExitToConstIfGtZ;
+	case IROp::ExitToConstIfFpTrue: return IROp::ExitToConstIfFpFalse;
+	case IROp::ExitToConstIfFpFalse: return IROp::ExitToConstIfFpTrue;
+	default:
+		_dbg_assert_(false);
+		return op;
+	}
+}
+
+void IRJit::ProfileBlockExit(u32 offset, u32 pc) {
+	// Avoid the binary search for the block number most of the time, hot loops only touch a few blocks.
+	TraceLookup &lookup = traceLookup_[offset & 0xFF];
+	if (lookup.offset != offset) {
+		lookup.offset = offset;
+		lookup.blockNum = blocks_.GetBlockNumFromIRArenaOffset(offset);
+	}
+	int block_num = lookup.blockNum;
+	if (block_num < 0)
+		return;
+	if (block_num >= (int)traceProfiles_.size())
+		traceProfiles_.resize(blocks_.GetNumBlocks());
+
+	TraceProfile &profile = traceProfiles_[block_num];
+	if (profile.done)
+		return;
+
+	if (profile.executions == 0) {
+		const IRBlock *block = blocks_.GetBlock(block_num);
+		const IRInst *instructions = blocks_.GetBlockInstructionPtr(*block);
+		for (int i = 0; i < block->GetNumIRInstructions() && profile.numExits < TRACE_MAX_PROFILED_EXITS; ++i) {
+			const IRInst &inst = instructions[i];
+			if (inst.op == IROp::ExitToConst || IsConditionalConstExit(inst.op))
+				profile.exitTarget[profile.numExits++] = inst.constant;
+		}
+		if (profile.numExits == 0) {
+			// Only leaves through a register jump, syscall, etc.  Nowhere known to continue a trace to.
+			profile.done = true;
+			return;
+		}
+	}
+
+	profile.executions++;
+	for (int i = 0; i < profile.numExits; ++i) {
+		if (pc == profile.exitTarget[i]) {
+			profile.exitTaken[i]++;
+			break;
+		}
+	}
+
+	if (profile.executions >= TRACE_HOT_EXECUTIONS) {
+		profile.done = true;
+		FormTrace(block_num);
+	}
+}
+
+bool IRJit::GetHotTraceExit(int block_num, u32 minExecutions, u32 *target) const {
+	if (block_num < 0 || block_num >= (int)traceProfiles_.size())
+		return false;
+	const TraceProfile &profile = traceProfiles_[block_num];
+	if (profile.executions < minExecutions)
+		return false;
+	for (int i = 0; i < profile.numExits; ++i) {
+		if (IsHotRatio(profile.exitTaken[i], profile.executions)) {
+			*target = profile.exitTarget[i];
+			return true;
+		}
+	}
+	return false;
+}
+
+// Makes the block at the end of the trace continue towards target, leaving the other way through a side exit.
+static bool FollowTraceExit(std::vector<IRInst> &trace, size_t blockStart, u32 target) {
+	IRInst &last = trace.back();
+	if (last.op != IROp::ExitToConst)
+		return false;
+	if (last.constant == target)
+		return true;
+
+	// The likely way is the conditional exit right before.  Flip it, so the final exit goes there instead.
+	// If anything runs in between (like a likely branch's delay slot), it can't be flipped.
+	if (trace.size() - blockStart < 2)
+		return false;
+	IRInst &cond = trace[trace.size() - 2];
+	if (!IsConditionalConstExit(cond.op) || cond.constant != target)
+		return false;
+	cond.op = InvertConditionalExit(cond.op);
+	cond.constant = last.constant;
+	last.constant = target;
+	return true;
+}
+
+static bool CanContinueTrace(const std::vector<IRInst> &instructions) {
+	for (const IRInst &inst : instructions) {
+		switch (inst.op) {
+		case IROp::Syscall:
+		case IROp::CallReplacement:
+		case IROp::Interpret:
+		case IROp::Break:
+		case IROp::Breakpoint:
+		case IROp::MemoryCheck:
+		case IROp::ExitToPC:
+			// These can change PC or thread behind our back.
+			return false;
+		default:
+			break;
+		}
+	}
+	return true;
+}
+
+bool IRJit::FormTrace(int block_num) {
+	// The native backends have no use for the trace exits, and never profile.
+	_dbg_assert_(!compileToNative_);
+	const IRBlock *block = blocks_.GetBlock(block_num);
+	if (!block || !block->IsValid() || mipsTracer.tracing_enabled)
+		return false;
+	u32 target;
+	if (!GetHotTraceExit(block_num, TRACE_HOT_EXECUTIONS, &target))
+		return false;
+
+	const u32 start = block->GetOriginalStart();
+	u32 end = start;
+	u32 addr = start;
+	int count = 0;
+	std::vector<IRInst> trace;
+	for (int i = 0; i < TRACE_MAX_BLOCKS; ++i) {
+		// We need the raw IR so the passes can see across the boundaries.
+		std::vector<IRInst> instructions;
+		std::vector<IRInst> raw;
+		u32 mipsBytes = 0;
+		frontend_.DoJit(addr, instructions, mipsBytes, false, &raw);
+		if (raw.empty() || addr < start || addr + mipsBytes - start > TRACE_MAX_BYTES || trace.size() + raw.size() > TRACE_MAX_INSTRUCTIONS)
+			break;
+
+		// The previous block's final exit now only leaves if CoreTiming has something due, just like
+		// the dispatcher would check between the blocks.  Otherwise it falls through into this one.
+		if (!trace.empty())
+			trace.back().op = IROp::ExitToConstIfDowncountLtZ;
+		const size_t blockStart = trace.size();
+		trace.insert(trace.end(), raw.begin(), raw.end());
+		end = std::max(end, addr + mipsBytes);
+		count++;
+
+		// The first block is known to be hot, after that only follow edges we've seen taken often.
+		if (i != 0 && !GetHotTraceExit(blocks_.GetBlockNumberFromStartAddress(addr), TRACE_HOT_EXECUTIONS / 10, &target))
+			break;
+		if (!CanContinueTrace(raw) || !FollowTraceExit(trace, blockStart, target))
+			break;
+		addr = target;
+	}
+
+	if (frontend_.CheckRounding(start)) {
+		// Our assumptions are all wrong so it's clean-slate time.
+		ClearCache();
+		return false;
+	}
+	if (count < 2)
+		return false;
+
+	IRWriter in, out;
+	in.Reserve(trace.size());
+	for (const IRInst &inst : trace)
+		in.Write(inst);
+	IRFrontend::OptimizeIR(in, out, frontend_.GetOptions());
+
+	int new_num = ReplaceBlock(block_num, end - start, out.GetInstructions());
+	if (new_num < 0)
+		return false;
+
+	// Don't build traces out of traces.
+	traceProfiles_.resize(blocks_.GetNumBlocks());
+	traceProfiles_[new_num].done = true;
+	DEBUG_LOG(Log::JIT, "Formed a trace of %d blocks at %08x (%d bytes, %d IR instructions)", count, start, end - start, (int)out.GetInstructions().size());
 	return true;
 }
 
+void IRJit::WaitForBackgroundTasks() {
+	std::unique_lock<std::mutex> guard(bgLock_);
+	bgCond_.wait(guard, [&] { return bgPending_ == 0; });
+	bgResults_.clear();
+	bgResultsReady_ = false;
+}
+
 void IRJit::CompileFunction(u32 start_address, u32 length) {
 	_dbg_assert_(compilerEnabled_);
 
@@ -277,6 +636,10 @@ void IRJit::RunLoopUntil(u64 globalticks) {
 			break;
 		}
 
+		if (bgResultsReady_) {
+			InstallBackgroundResults();
+		}
+
 		MIPSState *mips = mips_;
 #ifdef _DEBUG
 		compilerEnabled_ = false;
@@ -310,6 +673,9 @@ void IRJit::RunLoopUntil(u64 globalticks) {
 					Core_ExecException(mips->pc, block->GetOriginalStart(), ExecExceptionType::JUMP);
 					break;
 				}
+				if (traceFormation_) {
+					ProfileBlockExit(offset, mips->pc);
+				}
 			} else {
 				// RestoreRoundingMode(true);
 #ifdef _DEBUG
@@ -628,6 +994,218 @@ int IRBlockCache::GetBlockNumberFromStartAddress(u32 em_address, bool realBlocks
 	return best;
 }
 
+static const u32 IR_DISK_CACHE_MAGIC = 0x43425249;  // "IRBC"
+// Bump this whenever IROp or the frontend output changes in an incompatible way.
+static const u32 IR_DISK_CACHE_VERSION = 2;
+
+struct IRDiskCacheHeader {
+	u32 magic;
+	u32 version;
+	u64 buildHash;
+	u32 instSize;
+	u32 disableFlags;
+	u32 optionFlags;
+	u32 reserved;
+	u32 numBlocks;
+	u32 numInstructions;
+};
+
+struct IRDiskCacheBlock {
+	u32 origAddr;
+	u32 origSize;
+	u64 hash;
+	u32 numInstructions;
+	u32 compileFlags;
+};
+
+static u32 IROptionsToFlags(const IROptions &opts) {
+	u32 flags = 0;
+	flags |= opts.unalignedLoadStore ? 1 : 0;
+	flags |= opts.unalignedLoadStoreVec4 ? 2 : 0;
+	flags |= opts.preferVec4 ? 4 : 0;
+	flags |= opts.preferVec4Dot ? 8 : 0;
+	flags |= opts.optimizeForInterpreter ? 16 : 0;
+	return flags;
+}
+
+static u64 BuildHash() {
+	// Replacement function numbers and IR encodings can change with any build.
+	return XXH3_64bits(PPSSPP_GIT_VERSION, strlen(PPSSPP_GIT_VERSION));
+}
+
+static u64 HashMIPSCode(u32 addr, u32 size) {
+	// This is unfortunate. In case there are emuhacks, we have to make a copy.
+	// If we could hash while reading we could avoid this.
+	std::vector<u32> buffer;
+	buffer.resize(size / 4);
+	size_t pos = 0;
+	for (u32 off = 0; off < size; off += 4) {
+		// Let's actually hash the replacement, if any.
+		MIPSOpcode instr = Memory::ReadUnchecked_Instruction(addr + off, false);
+		buffer[pos++] = instr.encoding;
+	}
+	return XXH3_64bits(&buffer[0], size);
+}
+
+static bool IsDiskCacheable(const IRInst *inst, u32 count) {
+	for (u32 i = 0; i < count; ++i) {
+		switch (inst[i].op) {
+		case IROp::Breakpoint:
+		case IROp::MemoryCheck:
+		case IROp::LogIRBlock:
+			// These depend on debugger state, not just the code.
+			return false;
+		default:
+			break;
+		}
+	}
+	return true;
+}
+
+bool IRBlockCache::SaveDiskCache(const Path &filename, const IROptions &opts) const {
+	std::vector<IRDiskCacheBlock> entries;
+	std::vector<IRInst> insts;
+	std::set<u32> written;
+
+	for (const IRBlock &b : blocks_) {
+		// Loaded IR is never optimized again, so skip blocks still waiting on the background
+		// optimizer, as well as traces (those get rebuilt from profiling of the plain blocks.)
+		if (!b.IsValid() || b.GetHash() == 0 || !b.IsDiskCacheable())
+			continue;
+		const IRInst *blockInsts = GetBlockInstructionPtr(b);
+		if (!IsDiskCacheable(blockInsts, b.GetNumIRInstructions()))
+			continue;
+
+		IRDiskCacheBlock entry{};
+		b.GetRange(&entry.origAddr, &entry.origSize);
+		if (!written.insert(entry.origAddr).second)
+			continue;
+		entry.hash = b.GetHash();
+		entry.numInstructions = b.GetNumIRInstructions();
+		entry.compileFlags = b.GetCompileFlags();
+		entries.push_back(entry);
+		insts.insert(insts.end(), blockInsts, blockInsts + entry.numInstructions);
+	}
+
+	// Keep what we loaded but didn't get to use this time (other levels, overlays, etc.)
+	for (const auto &iter : diskBlocks_) {
+		if (written.find(iter.first) != written.end())
+			continue;
+		for (const DiskCachedBlock &cached : iter.second) {
+			IRDiskCacheBlock entry{};
+			entry.origAddr = iter.first;
+			entry.origSize = cached.origSize;
+			entry.hash = cached.hash;
+			entry.numInstructions = cached.numInstructions;
+			entry.compileFlags = cached.compileFlags;
+			entries.push_back(entry);
+			insts.insert(insts.end(), diskArena_.begin() + cached.arenaOffset, diskArena_.begin() + cached.arenaOffset + cached.numInstructions);
+		}
+	}
+
+	if (entries.empty())
+		return false;
+
+	IRDiskCacheHeader header{};
+	header.magic = IR_DISK_CACHE_MAGIC;
+	header.version = IR_DISK_CACHE_VERSION;
+	header.buildHash = BuildHash();
+	header.instSize = (u32)sizeof(IRInst);
+	header.disableFlags = opts.disableFlags;
+	header.optionFlags = IROptionsToFlags(opts);
+	header.numBlocks = (u32)entries.size();
+	header.numInstructions = (u32)insts.size();
+
+	File::IOFile f(filename, "wb");
+	if (!f.IsOpen())
+		return false;
+	bool success = f.WriteArray(&header, 1);
+	success = success && f.WriteArray(entries.data(), entries.size());
+	success = success && f.WriteArray(insts.data(), insts.size());
+	if (!success) {
+		ERROR_LOG(Log::JIT, "Failed to write IR block cache, disk full?");
+		f.Close();
+		File::Delete(filename);
+		return false;
+	}
+
+	NOTICE_LOG(Log::JIT, "Saved %d IR blocks (%d instructions) to the disk cache", (int)entries.size(), (int)insts.size());
+	return true;
+}
+
+bool IRBlockCache::LoadDiskCache(const Path &filename, const IROptions &opts) {
+	diskBlocks_.clear();
+	diskArena_.clear();
+
+	File::IOFile f(filename, "rb");
+	if (!f.IsOpen())
+		return false;
+
+	IRDiskCacheHeader header{};
+	if (!f.ReadArray(&header, 1) || header.magic != IR_DISK_CACHE_MAGIC) {
+		WARN_LOG(Log::JIT, "IR block cache magic mismatch");
+		return false;
+	}
+	if (header.version != IR_DISK_CACHE_VERSION || header.buildHash != BuildHash() || header.instSize != (u32)sizeof(IRInst)) {
+		INFO_LOG(Log::JIT, "IR block cache is from a different build, ignoring");
+		return false;
+	}
+	if (header.disableFlags != opts.disableFlags || header.optionFlags != IROptionsToFlags(opts)) {
+		INFO_LOG(Log::JIT, "IR block cache options mismatch, ignoring");
+		return false;
+	}
+	// Same limit as the arena in AllocateBlock, guards against garbage sizes.
+	if (header.numInstructions >= 0x1000000 || header.numBlocks > header.numInstructions) {
+		ERROR_LOG(Log::JIT, "IR block cache corrupt");
+		return false;
+	}
+
+	std::vector<IRDiskCacheBlock> entries;
+	entries.resize(header.numBlocks);
+	diskArena_.resize(header.numInstructions);
+	bool success = f.ReadArray(entries.data(), entries.size());
+	success = success && f.ReadArray(diskArena_.data(), diskArena_.size());
+	if (!success) {
+		ERROR_LOG(Log::JIT, "IR block cache truncated");
+		diskArena_.clear();
+		return false;
+	}
+
+	u32 offset = 0;
+	for (const IRDiskCacheBlock &entry : entries) {
+		if (entry.numInstructions == 0 || entry.numInstructions > header.numInstructions - offset || (entry.origSize & 3) != 0 || entry.origSize == 0) {
+			ERROR_LOG(Log::JIT, "IR block cache corrupt");
+			diskBlocks_.clear();
+			diskArena_.clear();
+			return false;
+		}
+		diskBlocks_[entry.origAddr].push_back(DiskCachedBlock{ entry.origSize, offset, entry.numInstructions, entry.hash, entry.compileFlags });
+		offset += entry.numInstructions;
+	}
+
+	INFO_LOG(Log::JIT, "Loaded %d IR blocks from the disk cache", (int)entries.size());
+	return true;
+}
+
+bool IRBlockCache::FindDiskCachedBlock(u32 em_address, u32 compileFlags, std::vector<IRInst> &instructions, u32 &mipsBytes) const {
+	auto iter = diskBlocks_.find(em_address);
+	if (iter == diskBlocks_.end())
+		return false;
+
+	for (const DiskCachedBlock &cached : iter->second) {
+		if (cached.compileFlags != compileFlags)
+			continue;
+		if (!Memory::IsValidRange(em_address, cached.origSize))
+			continue;
+		if (HashMIPSCode(em_address, cached.origSize) != cached.hash)
+			continue;
+		instructions.assign(diskArena_.begin() + cached.arenaOffset, diskArena_.begin() + cached.arenaOffset + cached.numInstructions);
+		mipsBytes = cached.origSize;
+		return true;
+	}
+	return false;
+}
+
 bool IRBlock::HasOriginalFirstOp() const {
 	return Memory::ReadUnchecked_U32(origAddr_) == origFirstOpcode_.encoding;
 }
@@ -671,17 +1249,7 @@ void IRBlock::Destroy(int cookie) {
 
 u64 IRBlock::CalculateHash() const {
 	if (origAddr_) {
-		// This is unfortunate. In case there are emuhacks, we have to make a copy.
-		// If we could hash while reading we could avoid this.
-		std::vector<u32> buffer;
-		buffer.resize(origSize_ / 4);
-		size_t pos = 0;
-		for (u32 off = 0; off < origSize_; off += 4) {
-			// Let's actually hash the replacement, if any.
-			MIPSOpcode instr = Memory::ReadUnchecked_Instruction(origAddr_ + off, false);
-			buffer[pos++] = instr.encoding;
-		}
-		return XXH3_64bits(&buffer[0], origSize_);
+		return HashMIPSCode(origAddr_, origSize_);
 	}
 	return 0;
 }
@@ -17,11 +17,15 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <cstring>
+#include <mutex>
 #include <unordered_map>
 
 #include "Common/CommonTypes.h"
 #include "Common/CPUDetect.h"
+#include "Common/File/Path.h"
 #include "Core/MIPS/JitCommon/JitBlockCache.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/MIPS/IR/IRRegCache.h"
@@ -59,6 +63,8 @@ class IRBlock {
 		origFirstOpcode_ = b.origFirstOpcode_;
 		nativeOffset_ = b.nativeOffset_;
 		numIRInstructions_ = b.numIRInstructions_;
+		compileFlags_ = b.compileFlags_;
+		diskCacheable_ = b.diskCacheable_;
 		b.arenaOffset_ = 0xFFFFFFFF;
 	}
 
@@ -94,6 +100,20 @@ class IRBlock {
 	u64 GetHash() const {
 		return hash_;
 	}
+	// The frontend flags in effect when this block was compiled, which the IR depends on.
+	void SetCompileFlags(u32 flags) {
+		compileFlags_ = flags;
+	}
+	u32 GetCompileFlags() const {
+		return compileFlags_;
+	}
+	// Only fully optimized plain blocks go in the disk cache, see IRBlockCache::SaveDiskCache.
+	void SetDiskCacheable(bool cacheable) {
+		diskCacheable_ = cacheable;
+	}
+	bool IsDiskCacheable() const {
+		return diskCacheable_;
+	}
 
 	void Finalize(int number);
 	void Destroy(int number);
@@ -114,6 +134,8 @@ class IRBlock {
 	u32 origSize_ = 0;
 	MIPSOpcode origFirstOpcode_ = MIPSOpcode(0x68FFFFFF);
 	u32 numIRInstructions_ = 0;
+	u32 compileFlags_ = 0;
+	bool diskCacheable_ = false;
 };
 
 class IRBlockCache : public JitBlockCacheDebugInterface {
@@ -192,12 +214,32 @@ class IRBlockCache : public JitBlockCacheDebugInterface {
 #endif
 	}
 
+	// Persistent on-disk cache of the optimized IR. Blocks are keyed by the hash of their original
+	// MIPS code and the frontend flags they were compiled with, the whole file by the IROptions.
+	bool SaveDiskCache(const Path &filename, const IROptions &opts) const;
+	bool LoadDiskCache(const Path &filename, const IROptions &opts);
+	// Returns true and fills in instructions if a cached block matches the code currently at em_address.
+	bool FindDiskCachedBlock(u32 em_address, u32 compileFlags, std::vector<IRInst> &instructions, u32 &mipsBytes) const;
+	bool HasDiskCache() const { return !diskBlocks_.empty(); }
+
 private:
+	struct DiskCachedBlock {
+		u32 origSize;
+		u32 arenaOffset;
+		u32 numInstructions;
+		u64 hash;
+		u32 compileFlags;
+	};
+
 	u32 AddressToPage(u32 addr) const;
 	bool compileToNative_;
 	std::vector<IRBlock> blocks_;
 	std::vector<IRInst> arena_;
 	std::unordered_map<u32, std::vector<int>> byPage_;
+
+	// Blocks loaded from the disk cache, by original address. Not yet validated against memory.
+	std::unordered_map<u32, std::vector<DiskCachedBlock>> diskBlocks_;
+	std::vector<IRInst> diskArena_;
 };
 
 class IRJit : public JitInterface {
@@ -242,7 +284,57 @@ class IRJit : public JitInterface {
 	virtual bool CompileNativeBlock(IRBlockCache *irBlockCache, int block_num, bool preload) { return true; }
 	virtual void FinalizeNativeBlock(IRBlockCache *irBlockCache, int block_num) {}
 
+	void QueueBackgroundOptimize(int block_num, std::vector<IRInst> &&unoptimized);
+	void InstallBackgroundResults();
+	void WaitForBackgroundTasks();
+	// Swaps in new IR for a block at the same start address. Returns the new block number, or -1.
+	int ReplaceBlock(int block_num, u32 mipsBytes, const std::vector<IRInst> &instructions);
+
+	void ProfileBlockExit(u32 offset, u32 pc);
+	bool GetHotTraceExit(int block_num, u32 minExecutions, u32 *target) const;
+	bool FormTrace(int block_num);
+
+	struct BackgroundResult {
+		u32 em_address;
+		u64 hash;
+		u32 generation;
+		std::vector<IRInst> instructions;
+	};
+
 	bool compileToNative_;
+	bool useDiskCache_ = false;
+	Path diskCachePath_;
+
+	// When enabled, new blocks first run with minimally processed IR, and get swapped for the
+	// fully optimized IR once a worker thread has run the passes. IR interpreter only.
+	bool backgroundCompile_ = false;
+	std::mutex bgLock_;
+	std::condition_variable bgCond_;
+	std::vector<BackgroundResult> bgResults_;
+	std::atomic<bool> bgResultsReady_{};
+	int bgPending_ = 0;
+	u32 bgGeneration_ = 0;
+
+	// Trace formation: counts how often each block runs and which of its constant exits it leaves through,
+	// and recompiles hot chains of blocks as one along the likely direction, so the passes can optimize across them.
+	enum {
+		TRACE_MAX_PROFILED_EXITS = 4,
+	};
+	struct TraceProfile {
+		u32 executions;
+		// Conditional exits come first, in block order.  Usually there's one of those, then the final exit.
+		u32 exitTarget[TRACE_MAX_PROFILED_EXITS];
+		u32 exitTaken[TRACE_MAX_PROFILED_EXITS];
+		u8 numExits;
+		bool done;
+	};
+	struct TraceLookup {
+		u32 offset;
+		int blockNum;
+	};
+	bool traceFormation_ = false;
+	std::vector<TraceProfile> traceProfiles_;
+	TraceLookup traceLookup_[256];
 
 	JitOptions jo;
 
@@ -56,6 +56,7 @@
 namespace MIPSComp {
 	JitInterface *jit;
 	std::recursive_mutex jitLock;
+	JitStats jitStats;
 
 	void JitAt() {
 		// TODO: We could probably check for a bad pc here, and fire an exception. Could spare us from some crashes.
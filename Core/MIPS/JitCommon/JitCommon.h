@@ -172,8 +172,21 @@ namespace MIPSComp {
 	// This seems to be the same for all branch types.
 	u32 ResolveNotTakenTarget(const BranchInfo &branchInfo);
 
+	// Only collected while coreCollectDebugStats is set, like gpuStats.
+	struct JitStats {
+		void ResetFrame() {
+			timeCompiling = 0.0;
+			numCompiles = 0;
+		}
+
+		// In seconds.
+		double timeCompiling;
+		int numCompiles;
+	};
+
 	extern JitInterface *jit;
 	extern std::recursive_mutex jitLock;
+	extern JitStats jitStats;
 
 	void DoDummyJitState(PointerWrap &p);
 
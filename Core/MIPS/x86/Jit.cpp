@@ -26,6 +26,7 @@
 
 #include "Common/Serialize/Serializer.h"
 #include "Common/Serialize/SerializeFuncs.h"
+#include "Common/TimeUtil.h"
 #include "Core/Core.h"
 #include "Core/MemMap.h"
 #include "Core/System.h"
@@ -300,6 +301,9 @@ void Jit::EatInstruction(MIPSOpcode op) {
 
 void Jit::Compile(u32 em_address) {
 	PROFILE_THIS_SCOPE("jitc");
+	TimeCollector collectStat(&jitStats.timeCompiling, coreCollectDebugStats);
+	if (coreCollectDebugStats)
+		jitStats.numCompiles++;
 	if (GetSpaceLeft() < 0x10000 || blocks.IsFull()) {
 		ClearCache();
 	}
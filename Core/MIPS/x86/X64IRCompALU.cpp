@@ -745,22 +745,34 @@ void X64JitBackend::CompIR_Mult(IRInst inst) {
 void X64JitBackend::CompIR_Shift(IRInst inst) {
 	CONDITIONAL_DISABLE;
 
+	auto mapForShift = [&]() -> OpArg {
+		// A statically allocated src2 can't be moved into ECX, so copy it there instead.
+		if (regs_.IsGPRStatic(inst.src2)) {
+			regs_.ReserveAndLockXGPR(RCX);
+			regs_.Map(inst);
+			MOV(32, R(ECX), regs_.R(inst.src2));
+			return R(ECX);
+		}
+		regs_.MapWithFlags(inst, X64Map::NONE, X64Map::NONE, X64Map::SHIFT);
+		return regs_.R(inst.src2);
+	};
+
 	switch (inst.op) {
 	case IROp::Shl:
 		if (cpu_info.bBMI2) {
 			regs_.Map(inst);
 			SHLX(32, regs_.RX(inst.dest), regs_.R(inst.src1), regs_.RX(inst.src2));
 		} else {
-			regs_.MapWithFlags(inst, X64Map::NONE, X64Map::NONE, X64Map::SHIFT);
+			OpArg shift = mapForShift();
 			if (inst.dest == inst.src1) {
-				SHL(32, regs_.R(inst.dest), regs_.R(inst.src2));
+				SHL(32, regs_.R(inst.dest), shift);
 			} else if (inst.dest == inst.src2) {
 				MOV(32, R(SCRATCH1), regs_.R(inst.src1));
-				SHL(32, R(SCRATCH1), regs_.R(inst.src2));
+				SHL(32, R(SCRATCH1), shift);
 				MOV(32, regs_.R(inst.dest), R(SCRATCH1));
 			} else {
 				MOV(32, regs_.R(inst.dest), regs_.R(inst.src1));
-				SHL(32, regs_.R(inst.dest), regs_.R(inst.src2));
+				SHL(32, regs_.R(inst.dest), shift);
 			}
 		}
 		break;
@@ -770,16 +782,16 @@ void X64JitBackend::CompIR_Shift(IRInst inst) {
 			regs_.Map(inst);
 			SHRX(32, regs_.RX(inst.dest), regs_.R(inst.src1), regs_.RX(inst.src2));
 		} else {
-			regs_.MapWithFlags(inst, X64Map::NONE, X64Map::NONE, X64Map::SHIFT);
+			OpArg shift = mapForShift();
 			if (inst.dest == inst.src1) {
-				SHR(32, regs_.R(inst.dest), regs_.R(inst.src2));
+				SHR(32, regs_.R(inst.dest), shift);
 			} else if (inst.dest == inst.src2) {
 				MOV(32, R(SCRATCH1), regs_.R(inst.src1));
-				SHR(32, R(SCRATCH1), regs_.R(inst.src2));
+				SHR(32, R(SCRATCH1), shift);
 				MOV(32, regs_.R(inst.dest), R(SCRATCH1));
 			} else {
 				MOV(32, regs_.R(inst.dest), regs_.R(inst.src1));
-				SHR(32, regs_.R(inst.dest), regs_.R(inst.src2));
+				SHR(32, regs_.R(inst.dest), shift);
 			}
 		}
 		break;
@@ -789,33 +801,35 @@ void X64JitBackend::CompIR_Shift(IRInst inst) {
 			regs_.Map(inst);
 			SARX(32, regs_.RX(inst.dest), regs_.R(inst.src1), regs_.RX(inst.src2));
 		} else {
-			regs_.MapWithFlags(inst, X64Map::NONE, X64Map::NONE, X64Map::SHIFT);
+			OpArg shift = mapForShift();
 			if (inst.dest == inst.src1) {
-				SAR(32, regs_.R(inst.dest), regs_.R(inst.src2));
+				SAR(32, regs_.R(inst.dest), shift);
 			} else if (inst.dest == inst.src2) {
 				MOV(32, R(SCRATCH1), regs_.R(inst.src1));
-				SAR(32, R(SCRATCH1), regs_.R(inst.src2));
+				SAR(32, R(SCRATCH1), shift);
 				MOV(32, regs_.R(inst.dest), R(SCRATCH1));
 			} else {
 				MOV(32, regs_.R(inst.dest), regs_.R(inst.src1));
-				SAR(32, regs_.R(inst.dest), regs_.R(inst.src2));
+				SAR(32, regs_.R(inst.dest), shift);
 			}
 		}
 		break;
 
 	case IROp::Ror:
-		regs_.MapWithFlags(inst, X64Map::NONE, X64Map::NONE, X64Map::SHIFT);
+	{
+		OpArg shift = mapForShift();
 		if (inst.dest == inst.src1) {
-			ROR(32, regs_.R(inst.dest), regs_.R(inst.src2));
+			ROR(32, regs_.R(inst.dest), shift);
 		} else if (inst.dest == inst.src2) {
 			MOV(32, R(SCRATCH1), regs_.R(inst.src1));
-			ROR(32, R(SCRATCH1), regs_.R(inst.src2));
+			ROR(32, R(SCRATCH1), shift);
 			MOV(32, regs_.R(inst.dest), R(SCRATCH1));
 		} else {
 			MOV(32, regs_.R(inst.dest), regs_.R(inst.src1));
-			ROR(32, regs_.R(inst.dest), regs_.R(inst.src2));
+			ROR(32, regs_.R(inst.dest), shift);
 		}
 		break;
+	}
 
 	case IROp::ShlImm:
 		// Shouldn't happen, but let's be safe of any passes that modify the ops.
@@ -42,6 +42,10 @@ X64JitBackend::X64JitBackend(JitOptions &jitopt, IRBlockCache &blocks)
 		jo.enablePointerify = false;
 	}
 	jo.optimizeForInterpreter = false;
+#if PPSSPP_ARCH(AMD64)
+	// Keep a few hot GPRs in callee-saved regs across blocks, like the ARM64 and RISC-V backends.
+	jo.useStaticAlloc = !jo.Disabled(JitDisable::STATIC_ALLOC);
+#endif
 
 	// Since we store the offset, this is as big as it can be.
 	AllocCodeSpace(1024 * 1024 * 16);
@@ -380,7 +384,7 @@ void X64JitBackend::WriteDebugProfilerStatus(IRProfilerStatus status) {
 
 void X64JitBackend::SaveStaticRegisters() {
 	if (jo.useStaticAlloc) {
-		//CALL(saveStaticRegisters_);
+		CALL(saveStaticRegisters_);
 	} else if (jo.downcountInRegister) {
 		// Inline the single operation
 		MOV(32, MDisp(CTXREG, downcountOffset), R(DOWNCOUNTREG));
@@ -389,7 +393,7 @@ void X64JitBackend::SaveStaticRegisters() {
 
 void X64JitBackend::LoadStaticRegisters() {
 	if (jo.useStaticAlloc) {
-		//CALL(loadStaticRegisters_);
+		CALL(loadStaticRegisters_);
 	} else if (jo.downcountInRegister) {
 		MOV(32, R(DOWNCOUNTREG), MDisp(CTXREG, downcountOffset));
 	}
@@ -62,6 +62,14 @@ const int *X64IRRegCache::GetAllocationOrder(MIPSLoc type, MIPSMap flags, int &c
 			ESI, EDI, EDX, EBX, ECX,
 #endif
 		};
+#if PPSSPP_ARCH(AMD64)
+		// Same, minus the regs handed out by GetStaticAllocations().
+		static const int allocationOrderStaticAlloc[] = {
+			R8, R9, R10, R11, RDX, RCX,
+			// Intentionally last.
+			R15,
+		};
+#endif
 
 		if ((flags & X64Map::MASK) == X64Map::SHIFT) {
 			// It's a single option for shifts.
@@ -84,6 +92,12 @@ const int *X64IRRegCache::GetAllocationOrder(MIPSLoc type, MIPSMap flags, int &c
 			return lowSubRegAllocationOrder;
 		}
 #else
+		if (jo_->useStaticAlloc) {
+			count = ARRAY_SIZE(allocationOrderStaticAlloc);
+			if (jo_->reserveR15ForAsm)
+				count--;
+			return allocationOrderStaticAlloc;
+		}
 		if (jo_->reserveR15ForAsm) {
 			count = ARRAY_SIZE(allocationOrder) - 1;
 			return allocationOrder;
@@ -119,6 +133,50 @@ const int *X64IRRegCache::GetAllocationOrder(MIPSLoc type, MIPSMap flags, int &c
 	}
 }
 
+const X64IRRegCache::StaticAllocation *X64IRRegCache::GetStaticAllocations(int &count) const {
+#if PPSSPP_ARCH(AMD64)
+	// Only callee-saved regs, so these survive calls into C without flushing.
+	static const StaticAllocation allocs[] = {
+#ifdef _WIN32
+		{ MIPS_REG_SP, RSI, MIPSLoc::REG },
+		{ MIPS_REG_V0, RDI, MIPSLoc::REG },
+		{ MIPS_REG_A0, R12, MIPSLoc::REG },
+		{ MIPS_REG_RA, R13, MIPSLoc::REG },
+#else
+		{ MIPS_REG_SP, RBP, MIPSLoc::REG },
+		{ MIPS_REG_V0, R12, MIPSLoc::REG },
+		{ MIPS_REG_A0, R13, MIPSLoc::REG },
+#endif
+	};
+
+	if (jo_->useStaticAlloc) {
+		count = ARRAY_SIZE(allocs);
+		return allocs;
+	}
+#endif
+	return IRNativeRegCacheBase::GetStaticAllocations(count);
+}
+
+void X64IRRegCache::EmitLoadStaticRegisters() {
+	int count = 0;
+	const StaticAllocation *allocs = GetStaticAllocations(count);
+	// Note: must not modify EAX, the dispatcher may have a PC in it.
+	for (int i = 0; i < count; ++i) {
+		int offset = GetMipsRegOffset(allocs[i].mr);
+		emit_->MOV(32, ::R(FromNativeReg(allocs[i].nr)), MDisp(CTXREG, -128 + offset));
+	}
+}
+
+void X64IRRegCache::EmitSaveStaticRegisters() {
+	int count = 0;
+	const StaticAllocation *allocs = GetStaticAllocations(count);
+	// This only needs to run once (by Asm) so checks don't need to be fast.
+	for (int i = 0; i < count; ++i) {
+		int offset = GetMipsRegOffset(allocs[i].mr);
+		emit_->MOV(32, MDisp(CTXREG, -128 + offset), ::R(FromNativeReg(allocs[i].nr)));
+	}
+}
+
 void X64IRRegCache::FlushBeforeCall() {
 	// These registers are not preserved by function calls.
 #if PPSSPP_ARCH(AMD64)
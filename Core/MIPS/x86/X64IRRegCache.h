@@ -108,8 +108,17 @@ class X64IRRegCache : public IRNativeRegCacheBase {
 	Gen::X64Reg FX(IRReg preg);
 
 	static bool HasLowSubregister(Gen::X64Reg reg);
+	// Statically allocated regs never move, so they can't satisfy X64Map flags.
+	bool IsGPRStatic(IRReg gpr) const {
+		return mr[gpr].isStatic;
+	}
+
+	// These are called once on startup to generate functions, that you should then call.
+	void EmitLoadStaticRegisters();
+	void EmitSaveStaticRegisters();
 
 protected:
+	const StaticAllocation *GetStaticAllocations(int &count) const override;
 	const int *GetAllocationOrder(MIPSLoc type, MIPSMap flags, int &count, int &base) const override;
 	void AdjustNativeRegAsPtr(IRNativeReg nreg, bool state) override;
 
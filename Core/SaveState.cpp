@@ -19,6 +19,7 @@
 #include <vector>
 #include <thread>
 #include <mutex>
+#include <zstd.h>
 
 #include "Common/Data/Text/I18n.h"
 #include "Common/Thread/ThreadUtil.h"
@@ -171,6 +172,8 @@ double g_lastSaveTime = -1.0;
 
 			static std::vector<u8> buffer;
 			LockedDecompress(buffer, states_[n], bases_[baseMapping_[n]]);
+			if (buffer.empty())
+				return CChunkFileReader::ERROR_BAD_FILE;
 			CChunkFileReader::Error error = LoadFromRam(buffer, errorString);
 			rewindLastTime_ = time_now_d();
 			return error;
@@ -196,27 +199,54 @@ double g_lastSaveTime = -1.0;
 				return;
 
 			double start_time = time_now_d();
-			result.clear();
-			result.reserve(512 * 1024);
+			// First, only keep the blocks that differ from the base.
+			std::vector<u8> &delta = deltaBuffer_;
+			delta.clear();
+			delta.reserve(512 * 1024);
 			for (size_t i = 0; i < state.size(); i += BLOCK_SIZE)
 			{
 				int blockSize = std::min(BLOCK_SIZE, (int)(state.size() - i));
 				if (i + blockSize > base.size() || memcmp(&state[i], &base[i], blockSize) != 0)
 				{
-					result.push_back(1);
-					result.insert(result.end(), state.begin() + i, state.begin() + i + blockSize);
+					delta.push_back(1);
+					delta.insert(delta.end(), state.begin() + i, state.begin() + i + blockSize);
 				}
 				else
-					result.push_back(0);
+					delta.push_back(0);
+			}
+
+			// Then zstd the dirty blocks, which are mostly sparse RAM and compress well.
+			result.resize(ZSTD_compressBound(delta.size()));
+			size_t compressedSize = ZSTD_compress(&result[0], result.size(), &delta[0], delta.size(), ZSTD_LEVEL);
+			if (ZSTD_isError(compressedSize)) {
+				ERROR_LOG(Log::SaveState, "Rewind: Failed to compress save: %s", ZSTD_getErrorName(compressedSize));
+				result.clear();
+				return;
 			}
+			result.resize(compressedSize);
+			result.shrink_to_fit();
 
 			double taken_s = time_now_d() - start_time;
-			DEBUG_LOG(Log::SaveState, "Rewind: Compressed save from %d bytes to %d in %0.2f ms.", (int)state.size(), (int)result.size(), taken_s * 1000.0);
+			DEBUG_LOG(Log::SaveState, "Rewind: Compressed save from %d bytes to %d (%d before zstd) in %0.2f ms.", (int)state.size(), (int)result.size(), (int)delta.size(), taken_s * 1000.0);
 		}
 
-		void LockedDecompress(std::vector<u8> &result, const std::vector<u8> &compressed, const std::vector<u8> &base)
+		void LockedDecompress(std::vector<u8> &result, const std::vector<u8> &zcompressed, const std::vector<u8> &base)
 		{
 			result.clear();
+
+			std::vector<u8> &compressed = deltaBuffer_;
+			unsigned long long deltaSize = ZSTD_getFrameContentSize(&zcompressed[0], zcompressed.size());
+			if (deltaSize == ZSTD_CONTENTSIZE_ERROR || deltaSize == ZSTD_CONTENTSIZE_UNKNOWN) {
+				ERROR_LOG(Log::SaveState, "Rewind: Corrupt compressed save");
+				return;
+			}
+			compressed.resize((size_t)deltaSize);
+			size_t status = ZSTD_decompress(&compressed[0], compressed.size(), &zcompressed[0], zcompressed.size());
+			if (ZSTD_isError(status)) {
+				ERROR_LOG(Log::SaveState, "Rewind: Failed to decompress save: %s", ZSTD_getErrorName(status));
+				return;
+			}
+
 			result.reserve(base.size());
 			auto basePos = base.begin();
 			for (size_t i = 0; i < compressed.size(); )
@@ -261,6 +291,7 @@ double g_lastSaveTime = -1.0;
 				s.clear();
 			}
 			buffer_.clear();
+			deltaBuffer_.clear();
 			base_ = -1;
 			baseUsage_ = 0;
 			rewindLastTime_ = time_now_d();
@@ -297,6 +328,8 @@ double g_lastSaveTime = -1.0;
 	private:
 		const int BLOCK_SIZE = 8192;
 		const int REWIND_NUM_STATES = 20;
+		// Favor speed, this runs every few seconds while playing.
+		const int ZSTD_LEVEL = 1;
 		// TODO: Instead, based on size of compressed state?
 		const int BASE_USAGE_INTERVAL = 15;
 
@@ -312,6 +345,8 @@ double g_lastSaveTime = -1.0;
 		std::mutex lock_;
 		std::thread compressThread_;
 		std::vector<u8> buffer_;
+		// Uncompressed delta, reused between saves.  Protected by lock_.
+		std::vector<u8> deltaBuffer_;
 
 		int base_ = -1;
 		int baseUsage_ = 0;
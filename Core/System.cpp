@@ -45,6 +45,7 @@
 #include "Core/MemFault.h"
 #include "Core/HDRemaster.h"
 #include "Core/MIPS/MIPS.h"
+#include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/MIPS/MIPSAnalyst.h"
 #include "Core/MIPS/MIPSVFPUUtils.h"
 #include "Core/Debugger/SymbolMap.h"
@@ -390,6 +391,7 @@ void PSP_UpdateDebugStats(bool collectStats) {
 	if (!PSP_CoreParameter().frozen && !Core_IsStepping()) {
 		kernelStats.ResetFrame();
 		gpuStats.ResetFrame();
+		MIPSComp::jitStats.ResetFrame();
 	}
 }
 
@@ -25,6 +25,7 @@
 #include "Common/Math/CrossSIMD.h"
 #include "Common/Math/lin/matrix4x4.h"
 #include "Common/TimeUtil.h"
+#include "Core/MemMap.h"
 #include "Core/System.h"
 #include "Core/Config.h"
 #include "GPU/Common/DrawEngineCommon.h"
@@ -46,7 +47,17 @@ enum {
 	DEPTH_INDEXBUFFER_SIZE = VERTEX_BUFFER_MAX * 3 * sizeof(uint16_t),
 };
 
-DrawEngineCommon::DrawEngineCommon() : decoderMap_(32) {
+enum {
+	// Once the source data of an entry has stayed the same for a while, we hash it at most this many frames apart.
+	VERTEX_CACHE_MAX_HASH_INTERVAL = 8,
+	// Entries that keep changing are just decoded directly, the hash and copy would be a waste.
+	VERTEX_CACHE_MAX_CHANGES = 4,
+	VERTEX_CACHE_KILL_AGE = 120,
+	VERTEX_CACHE_DECIMATION_INTERVAL = 13,
+	VERTEX_CACHE_MAX_BYTES = 32 * 1024 * 1024,
+};
+
+DrawEngineCommon::DrawEngineCommon() : decoderMap_(32), vertexCache_(1024) {
 	if (g_Config.bVertexDecoderJit && (g_Config.iCpuCore == (int)CPUCore::JIT || g_Config.iCpuCore == (int)CPUCore::JIT_IR)) {
 		decJitCache_ = new VertexDecoderJitCache();
 	}
@@ -71,6 +82,8 @@ DrawEngineCommon::DrawEngineCommon() : decoderMap_(32) {
 	if (useDepthRaster_) {
 		depthDraws_.reserve(256);
 	}
+
+	useVertexCache_ = g_Config.bVertexCache;
 }
 
 DrawEngineCommon::~DrawEngineCommon() {
@@ -87,6 +100,7 @@ DrawEngineCommon::~DrawEngineCommon() {
 	decoderMap_.Iterate([&](const uint32_t vtype, VertexDecoder *decoder) {
 		delete decoder;
 	});
+	ClearVertexCache();
 	ClearSplineBezierWeights();
 }
 
@@ -117,6 +131,9 @@ std::string DrawEngineCommon::DebugGetVertexLoaderString(std::string id, DebugSh
 }
 
 void DrawEngineCommon::NotifyConfigChanged() {
+	// Decoders get recreated below, so cached entries would point at stale decoders.
+	ClearVertexCache();
+	useVertexCache_ = g_Config.bVertexCache;
 	if (decJitCache_)
 		decJitCache_->Clear();
 	lastVType_ = -1;
@@ -800,6 +817,10 @@ void DrawEngineCommon::BeginFrame() {
 		depthScreenVerts_ = (int *)AllocateMemoryPages(DEPTH_SCREENVERTS_SIZE, MEM_PROT_READ | MEM_PROT_WRITE);
 		depthIndices_ = (uint16_t *)AllocateMemoryPages(DEPTH_INDEXBUFFER_SIZE, MEM_PROT_READ | MEM_PROT_WRITE);
 	}
+	if (--vertexCacheDecimationCounter_ <= 0) {
+		DecimateVertexCache();
+		vertexCacheDecimationCounter_ = VERTEX_CACHE_DECIMATION_INTERVAL;
+	}
 }
 
 void DrawEngineCommon::DecodeVerts(VertexDecoder *dec, u8 *dest) {
@@ -823,12 +844,164 @@ void DrawEngineCommon::DecodeVerts(VertexDecoder *dec, u8 *dest) {
 		}
 
 		// Decode the verts (and at the same time apply morphing/skinning). Simple.
-		dec->DecodeVerts(dest + numDecodedVerts_ * stride, dv.verts, &dv.uvScale, indexLowerBound, indexUpperBound);
+		if (useVertexCache_) {
+			DecodeVertsCached(dec, dest + numDecodedVerts_ * stride, dv, indexLowerBound, indexUpperBound);
+		} else {
+			dec->DecodeVerts(dest + numDecodedVerts_ * stride, dv.verts, &dv.uvScale, indexLowerBound, indexUpperBound);
+		}
 		numDecodedVerts_ += indexUpperBound - indexLowerBound + 1;
 	}
 	decodeVertsCounter_ = i;
 }
 
+void DrawEngineCommon::DecodeVertsCached(VertexDecoder *dec, u8 *dest, const DeferredVerts &dv, int indexLowerBound, int indexUpperBound) {
+	// Morphing and skinning depend on GPU state that isn't part of the key, so never cache those.
+	if (dec->skinInDecode || (dec->VertexType() & GE_VTYPE_MORPHCOUNT_MASK) != 0) {
+		dec->DecodeVerts(dest, dv.verts, &dv.uvScale, indexLowerBound, indexUpperBound);
+		return;
+	}
+
+	VertexCacheKey key{};
+	key.verts = (uintptr_t)dv.verts;
+	key.dec = (uintptr_t)dec;
+	key.uvScale = dv.uvScale;
+	key.indexLowerBound = indexLowerBound;
+	key.indexUpperBound = indexUpperBound;
+
+	const int count = indexUpperBound - indexLowerBound + 1;
+	const size_t decodedSize = (size_t)count * dec->GetDecVtxFmt().stride;
+	const u8 *src = (const u8 *)dv.verts + indexLowerBound * dec->VertexSize();
+	const u32 srcSize = count * dec->VertexSize();
+
+	VertexCacheEntry *entry = vertexCache_.GetOrNull(key);
+	if (!entry) {
+		if (vertexCacheBytes_ + decodedSize > VERTEX_CACHE_MAX_BYTES) {
+			dec->DecodeVerts(dest, dv.verts, &dv.uvScale, indexLowerBound, indexUpperBound);
+			return;
+		}
+		entry = new VertexCacheEntry{};
+		entry->src = src;
+		entry->srcSize = srcSize;
+		entry->hash = XXH3_64bits(src, srcSize);
+		vertexCache_.Insert(key, entry);
+	} else if (entry->numChanges > VERTEX_CACHE_MAX_CHANGES) {
+		entry->lastFrame = gpuStats.numFlips;
+		dec->DecodeVerts(dest, dv.verts, &dv.uvScale, indexLowerBound, indexUpperBound);
+		return;
+	} else {
+		bool valid = !entry->invalidated;
+		entry->invalidated = false;
+		if (!valid) {
+			// Known to be written, so don't bother comparing. We still need the new hash.
+			entry->hash = XXH3_64bits(src, srcSize);
+			entry->hashInterval = 0;
+			entry->numChanges++;
+			entry->nextHashFrame = gpuStats.numFlips;
+		} else if (gpuStats.numFlips >= entry->nextHashFrame) {
+			const u64 hash = XXH3_64bits(src, srcSize);
+			if (hash == entry->hash) {
+				entry->hashInterval = entry->hashInterval == 0 ? 1 : std::min(entry->hashInterval * 2, (int)VERTEX_CACHE_MAX_HASH_INTERVAL);
+			} else {
+				entry->hash = hash;
+				entry->hashInterval = 0;
+				entry->numChanges++;
+				valid = false;
+			}
+			entry->nextHashFrame = gpuStats.numFlips + entry->hashInterval;
+		}
+		entry->lastFrame = gpuStats.numFlips;
+
+		if (valid) {
+			memcpy(dest, entry->decoded.data(), decodedSize);
+			gstate_c.vertexFullAlpha = gstate_c.vertexFullAlpha && entry->fullAlpha;
+			KnownVertexBounds &bounds = gstate_c.vertBounds;
+			bounds.minU = std::min(bounds.minU, entry->bounds.minU);
+			bounds.minV = std::min(bounds.minV, entry->bounds.minV);
+			bounds.maxU = std::max(bounds.maxU, entry->bounds.maxU);
+			bounds.maxV = std::max(bounds.maxV, entry->bounds.maxV);
+			return;
+		}
+	}
+
+	// Decode from scratch, capturing the side effects separately so we can replay them later.
+	const bool prevFullAlpha = gstate_c.vertexFullAlpha;
+	const KnownVertexBounds prevBounds = gstate_c.vertBounds;
+	gstate_c.vertexFullAlpha = true;
+	gstate_c.vertBounds = KnownVertexBounds{ 0xFFFF, 0xFFFF, 0, 0 };
+	dec->DecodeVerts(dest, dv.verts, &dv.uvScale, indexLowerBound, indexUpperBound);
+	entry->fullAlpha = gstate_c.vertexFullAlpha;
+	entry->bounds = gstate_c.vertBounds;
+	gstate_c.vertexFullAlpha = prevFullAlpha && entry->fullAlpha;
+	gstate_c.vertBounds.minU = std::min(prevBounds.minU, entry->bounds.minU);
+	gstate_c.vertBounds.minV = std::min(prevBounds.minV, entry->bounds.minV);
+	gstate_c.vertBounds.maxU = std::max(prevBounds.maxU, entry->bounds.maxU);
+	gstate_c.vertBounds.maxV = std::max(prevBounds.maxV, entry->bounds.maxV);
+
+	vertexCacheBytes_ -= entry->decoded.size();
+	entry->decoded.assign(dest, dest + decodedSize);
+	vertexCacheBytes_ += decodedSize;
+	entry->lastFrame = gpuStats.numFlips;
+}
+
+void DrawEngineCommon::DecimateVertexCache() {
+	if (vertexCache_.size() == 0) {
+		return;
+	}
+	std::vector<VertexCacheKey> toRemove;
+	vertexCache_.Iterate([&](const VertexCacheKey &key, VertexCacheEntry *entry) {
+		if (entry->lastFrame + VERTEX_CACHE_KILL_AGE < gpuStats.numFlips) {
+			toRemove.push_back(key);
+		}
+	});
+	for (const VertexCacheKey &key : toRemove) {
+		VertexCacheEntry *entry = vertexCache_.GetOrNull(key);
+		vertexCacheBytes_ -= entry->decoded.size();
+		delete entry;
+		vertexCache_.Remove(key);
+	}
+	vertexCache_.Maintain();
+}
+
+void DrawEngineCommon::InvalidateVertexCache(u32 addr, int size, GPUInvalidationType type) {
+	if (vertexCache_.size() == 0) {
+		return;
+	}
+	if (size <= 0 || type == GPU_INVALIDATE_ALL) {
+		// Everything needs to be checked again, and more often for a while.
+		vertexCache_.IterateMut([&](const VertexCacheKey &key, VertexCacheEntry *entry) {
+			entry->nextHashFrame = 0;
+			entry->hashInterval = 0;
+		});
+		return;
+	}
+
+	addr &= 0x3FFFFFFF;
+	if (!Memory::IsValidRange(addr, size)) {
+		return;
+	}
+	const u8 *start = Memory::GetPointerUnchecked(addr);
+	const u8 *end = start + size;
+	vertexCache_.IterateMut([&](const VertexCacheKey &key, VertexCacheEntry *entry) {
+		if (entry->src < end && entry->src + entry->srcSize > start) {
+			// Start the backoff over, like the texture cache does. A hint might not mean a change,
+			// but when the game or HLE told us it wrote the data, skip straight to decoding it again.
+			entry->nextHashFrame = 0;
+			entry->hashInterval = 0;
+			if (type == GPU_INVALIDATE_SAFE || type == GPU_INVALIDATE_FORCE) {
+				entry->invalidated = true;
+			}
+		}
+	});
+}
+
+void DrawEngineCommon::ClearVertexCache() {
+	vertexCache_.Iterate([&](const VertexCacheKey &key, VertexCacheEntry *entry) {
+		delete entry;
+	});
+	vertexCache_.Clear();
+	vertexCacheBytes_ = 0;
+}
+
 int DrawEngineCommon::DecodeInds() {
 	// Note that this should be able to continue a partial decode - we don't necessarily start from zero here (although we do most of the time).
 
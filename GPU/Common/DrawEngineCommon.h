@@ -22,6 +22,7 @@
 #include "Common/CommonTypes.h"
 #include "Common/Data/Collections/Hashmaps.h"
 
+#include "GPU/GPUDefinitions.h"
 #include "GPU/Math3D.h"
 #include "GPU/GPUState.h"
 #include "GPU/Common/GPUStateUtils.h"
@@ -166,6 +167,9 @@ class DrawEngineCommon {
 
 	void FlushQueuedDepth();
 
+	void InvalidateVertexCache(u32 addr, int size, GPUInvalidationType type);
+	void ClearVertexCache();
+
 protected:
 	virtual bool UpdateUseHWTessellation(bool enabled) const { return enabled; }
 	void UpdatePlanes();
@@ -317,6 +321,40 @@ class DrawEngineCommon {
 	uint32_t drawVertexOffsets_[MAX_DEFERRED_DRAW_VERTS];
 	DeferredInds drawInds_[MAX_DEFERRED_DRAW_INDS];
 
+	// Optional cache of decoded vertices, for games that draw the same static geometry every frame.
+	// The key must not contain padding, since DenseHashMap hashes and compares it as raw bytes.
+	struct VertexCacheKey {
+		uintptr_t verts;
+		uintptr_t dec;
+		UVScale uvScale;
+		u32 indexLowerBound;
+		u32 indexUpperBound;
+	};
+
+	struct VertexCacheEntry {
+		std::vector<u8> decoded;
+		const u8 *src;
+		u32 srcSize;
+		u64 hash;
+		int lastFrame;
+		int nextHashFrame;
+		int hashInterval;
+		int numChanges;
+		// Set when we're told the source was written, so it gets decoded again without comparing hashes.
+		bool invalidated;
+		// Side effects of the decode, which we need to replay when using the cached data.
+		bool fullAlpha;
+		KnownVertexBounds bounds;
+	};
+
+	void DecodeVertsCached(VertexDecoder *dec, u8 *dest, const DeferredVerts &dv, int indexLowerBound, int indexUpperBound);
+	void DecimateVertexCache();
+
+	DenseHashMap<VertexCacheKey, VertexCacheEntry *> vertexCache_;
+	size_t vertexCacheBytes_ = 0;
+	int vertexCacheDecimationCounter_ = 0;
+	bool useVertexCache_ = false;
+
 	VertexDecoder *dec_ = nullptr;
 	u32 lastVType_ = -1;  // corresponds to dec_.  Could really just pick it out of dec_...
 	int numDrawVerts_ = 0;
@@ -21,6 +21,7 @@
 #include "Common/CPUDetect.h"
 #include "Common/Math/math_util.h"
 #include "Common/GPU/OpenGL/GLFeatures.h"
+#include "Common/Thread/ParallelLoop.h"
 #include "Core/Config.h"
 #include "Core/System.h"
 #include "GPU/GPUState.h"
@@ -49,6 +50,9 @@
 // GL_TRIANGLES. Still need to sw transform to compute the extra two corners though.
 //
 
+// Full transforms (with lighting) are expensive enough per vertex that threading pays off at this batch size.
+static constexpr int MIN_VERTS_PER_TRANSFORM_THREAD = 1024;
+
 // The verts are in the order:  BR BL TL TR
 static void SwapUVs(TransformedVertex &a, TransformedVertex &b) {
 	float tempu = a.u;
@@ -164,7 +168,6 @@ void SoftwareTransform::Transform(int prim, u32 vertType, const DecVtxFormat &de
 	float widthFactor = (float) w / (float) gstate_c.curTextureWidth;
 	float heightFactor = (float) h / (float) gstate_c.curTextureHeight;
 
-	Lighter lighter(vertType);
 	float fog_end = getFloat24(gstate.fog1);
 	float fog_slope = getFloat24(gstate.fog2);
 	// Same fixup as in ShaderManagerGLES.cpp
@@ -212,162 +215,173 @@ void SoftwareTransform::Transform(int prim, u32 vertType, const DecVtxFormat &de
 	} else {
 		const Vec4f materialAmbientRGBA = Vec4f::FromRGBA(gstate.getMaterialAmbientRGBA());
 		// Okay, need to actually perform the full transform.
-		for (int index = 0; index < numDecodedVerts; index++) {
-			reader.Goto(index);
-
-			float v[3] = {0, 0, 0};
-			Vec4f c0 = Vec4f(1, 1, 1, 1);
-			Vec4f c1 = Vec4f(0, 0, 0, 0);
-			float uv[3] = {0, 0, 1};
-			float fogCoef = 1.0f;
-
-			float out[3];
-			float pos[3];
-			Vec3f normal(0, 0, 1);
-			Vec3f worldnormal(0, 0, 1);
-			reader.ReadPosNonThrough(pos);
-
-			float ruv[2] = { 0.0f, 0.0f };
-			if (reader.hasUV())
-				reader.ReadUV(ruv);
-
-			Vec4f unlitColor;
-			if (reader.hasColor0())
-				reader.ReadColor0(unlitColor.AsArray());
-			else
-				unlitColor = materialAmbientRGBA;
-			if (reader.hasNormal())
-				reader.ReadNrm(normal.AsArray());
-
-			Vec3ByMatrix43(out, pos, gstate.worldMatrix);
-			if (reader.hasNormal()) {
-				if (gstate.areNormalsReversed()) {
-					normal = -normal;
+		// Each vertex only depends on GPU state and its own input, so big batches are split across threads.
+		auto transformRange = [&](int lower, int upper) {
+			VertexReader reader(decoded, decVtxFormat, vertType);
+			Lighter lighter(vertType);
+			for (int index = lower; index < upper; index++) {
+				reader.Goto(index);
+
+				float v[3] = {0, 0, 0};
+				Vec4f c0 = Vec4f(1, 1, 1, 1);
+				Vec4f c1 = Vec4f(0, 0, 0, 0);
+				float uv[3] = {0, 0, 1};
+				float fogCoef = 1.0f;
+
+				float out[3];
+				float pos[3];
+				Vec3f normal(0, 0, 1);
+				Vec3f worldnormal(0, 0, 1);
+				reader.ReadPosNonThrough(pos);
+
+				float ruv[2] = { 0.0f, 0.0f };
+				if (reader.hasUV())
+					reader.ReadUV(ruv);
+
+				Vec4f unlitColor;
+				if (reader.hasColor0())
+					reader.ReadColor0(unlitColor.AsArray());
+				else
+					unlitColor = materialAmbientRGBA;
+				if (reader.hasNormal())
+					reader.ReadNrm(normal.AsArray());
+
+				Vec3ByMatrix43(out, pos, gstate.worldMatrix);
+				if (reader.hasNormal()) {
+					if (gstate.areNormalsReversed()) {
+						normal = -normal;
+					}
+					Norm3ByMatrix43(worldnormal.AsArray(), normal.AsArray(), gstate.worldMatrix);
+					worldnormal = worldnormal.NormalizedOr001(cpu_info.bSSE4_1);
 				}
-				Norm3ByMatrix43(worldnormal.AsArray(), normal.AsArray(), gstate.worldMatrix);
-				worldnormal = worldnormal.NormalizedOr001(cpu_info.bSSE4_1);
-			}
 
-			// Perform lighting here if enabled.
-			if (gstate.isLightingEnabled()) {
-				float litColor0[4];
-				float litColor1[4];
-				lighter.Light(litColor0, litColor1, unlitColor.AsArray(), out, worldnormal);
+				// Perform lighting here if enabled.
+				if (gstate.isLightingEnabled()) {
+					float litColor0[4];
+					float litColor1[4];
+					lighter.Light(litColor0, litColor1, unlitColor.AsArray(), out, worldnormal);
 
-				// Don't ignore gstate.lmode - we should send two colors in that case
-				for (int j = 0; j < 4; j++) {
-					c0[j] = litColor0[j];
-				}
-				if (lmode) {
-					// Separate colors
+					// Don't ignore gstate.lmode - we should send two colors in that case
 					for (int j = 0; j < 4; j++) {
-						c1[j] = litColor1[j];
+						c0[j] = litColor0[j];
+					}
+					if (lmode) {
+						// Separate colors
+						for (int j = 0; j < 4; j++) {
+							c1[j] = litColor1[j];
+						}
+					} else {
+						// Summed color into c0 (will clamp in ToRGBA().)
+						for (int j = 0; j < 4; j++) {
+							c0[j] += litColor1[j];
+						}
 					}
 				} else {
-					// Summed color into c0 (will clamp in ToRGBA().)
 					for (int j = 0; j < 4; j++) {
-						c0[j] += litColor1[j];
+						c0[j] = unlitColor[j];
+					}
+					if (lmode) {
+						// c1 is already 0.
 					}
 				}
-			} else {
-				for (int j = 0; j < 4; j++) {
-					c0[j] = unlitColor[j];
-				}
-				if (lmode) {
-					// c1 is already 0.
-				}
-			}
-
-			// Perform texture coordinate generation after the transform and lighting - one style of UV depends on lights.
-			switch (gstate.getUVGenMode()) {
-			case GE_TEXMAP_TEXTURE_COORDS:	// UV mapping
-			case GE_TEXMAP_UNKNOWN: // Seen in Riviera.  Unsure of meaning, but this works.
-				// We always prescale in the vertex decoder now.
-				uv[0] = ruv[0];
-				uv[1] = ruv[1];
-				uv[2] = 1.0f;
-				break;
 
-			case GE_TEXMAP_TEXTURE_MATRIX:
-				{
-					// Projection mapping
-					Vec3f source(0.0f, 0.0f, 1.0f);
-					switch (gstate.getUVProjMode())	{
-					case GE_PROJMAP_POSITION: // Use model space XYZ as source
-						source = pos;
-						break;
-
-					case GE_PROJMAP_UV: // Use unscaled UV as source
-						source = Vec3f(ruv[0], ruv[1], 0.0f);
-						break;
-
-					case GE_PROJMAP_NORMALIZED_NORMAL: // Use normalized normal as source
-						source = normal.Normalized(cpu_info.bSSE4_1);
-						if (!reader.hasNormal()) {
-							ERROR_LOG_REPORT(Log::G3D, "Normal projection mapping without normal?");
+				// Perform texture coordinate generation after the transform and lighting - one style of UV depends on lights.
+				switch (gstate.getUVGenMode()) {
+				case GE_TEXMAP_TEXTURE_COORDS:	// UV mapping
+				case GE_TEXMAP_UNKNOWN: // Seen in Riviera.  Unsure of meaning, but this works.
+					// We always prescale in the vertex decoder now.
+					uv[0] = ruv[0];
+					uv[1] = ruv[1];
+					uv[2] = 1.0f;
+					break;
+
+				case GE_TEXMAP_TEXTURE_MATRIX:
+					{
+						// Projection mapping
+						Vec3f source(0.0f, 0.0f, 1.0f);
+						switch (gstate.getUVProjMode())	{
+						case GE_PROJMAP_POSITION: // Use model space XYZ as source
+							source = pos;
+							break;
+
+						case GE_PROJMAP_UV: // Use unscaled UV as source
+							source = Vec3f(ruv[0], ruv[1], 0.0f);
+							break;
+
+						case GE_PROJMAP_NORMALIZED_NORMAL: // Use normalized normal as source
+							source = normal.Normalized(cpu_info.bSSE4_1);
+							if (!reader.hasNormal()) {
+								ERROR_LOG_REPORT(Log::G3D, "Normal projection mapping without normal?");
+							}
+							break;
+
+						case GE_PROJMAP_NORMAL: // Use non-normalized normal as source!
+							source = normal;
+							if (!reader.hasNormal()) {
+								ERROR_LOG_REPORT(Log::G3D, "Normal projection mapping without normal?");
+							}
+							break;
 						}
-						break;
 
-					case GE_PROJMAP_NORMAL: // Use non-normalized normal as source!
-						source = normal;
-						if (!reader.hasNormal()) {
-							ERROR_LOG_REPORT(Log::G3D, "Normal projection mapping without normal?");
-						}
-						break;
+						float uvw[3];
+						Vec3ByMatrix43(uvw, &source.x, gstate.tgenMatrix);
+						uv[0] = uvw[0];
+						uv[1] = uvw[1];
+						uv[2] = uvw[2];
 					}
+					break;
+
+				case GE_TEXMAP_ENVIRONMENT_MAP:
+					// Shade mapping - use two light sources to generate U and V.
+					{
+						auto getLPosFloat = [&](int l, int i) {
+							return getFloat24(gstate.lpos[l * 3 + i]);
+						};
+						auto getLPos = [&](int l) {
+							return Vec3f(getLPosFloat(l, 0), getLPosFloat(l, 1), getLPosFloat(l, 2));
+						};
+						auto calcShadingLPos = [&](int l) {
+							Vec3f pos = getLPos(l);
+							return pos.NormalizedOr001(cpu_info.bSSE4_1);
+						};
+						// Might not have lighting enabled, so don't use lighter.
+						Vec3f lightpos0 = calcShadingLPos(gstate.getUVLS0());
+						Vec3f lightpos1 = calcShadingLPos(gstate.getUVLS1());
+
+						uv[0] = (1.0f + Dot(lightpos0, worldnormal))/2.0f;
+						uv[1] = (1.0f + Dot(lightpos1, worldnormal))/2.0f;
+						uv[2] = 1.0f;
+					}
+					break;
 
-					float uvw[3];
-					Vec3ByMatrix43(uvw, &source.x, gstate.tgenMatrix);
-					uv[0] = uvw[0];
-					uv[1] = uvw[1];
-					uv[2] = uvw[2];
-				}
-				break;
-
-			case GE_TEXMAP_ENVIRONMENT_MAP:
-				// Shade mapping - use two light sources to generate U and V.
-				{
-					auto getLPosFloat = [&](int l, int i) {
-						return getFloat24(gstate.lpos[l * 3 + i]);
-					};
-					auto getLPos = [&](int l) {
-						return Vec3f(getLPosFloat(l, 0), getLPosFloat(l, 1), getLPosFloat(l, 2));
-					};
-					auto calcShadingLPos = [&](int l) {
-						Vec3f pos = getLPos(l);
-						return pos.NormalizedOr001(cpu_info.bSSE4_1);
-					};
-					// Might not have lighting enabled, so don't use lighter.
-					Vec3f lightpos0 = calcShadingLPos(gstate.getUVLS0());
-					Vec3f lightpos1 = calcShadingLPos(gstate.getUVLS1());
-
-					uv[0] = (1.0f + Dot(lightpos0, worldnormal))/2.0f;
-					uv[1] = (1.0f + Dot(lightpos1, worldnormal))/2.0f;
-					uv[2] = 1.0f;
+				default:
+					// Illegal
+					ERROR_LOG_REPORT(Log::G3D, "Impossible UV gen mode? %d", gstate.getUVGenMode());
+					break;
 				}
-				break;
 
-			default:
-				// Illegal
-				ERROR_LOG_REPORT(Log::G3D, "Impossible UV gen mode? %d", gstate.getUVGenMode());
-				break;
-			}
+				uv[0] = uv[0] * widthFactor;
+				uv[1] = uv[1] * heightFactor;
 
-			uv[0] = uv[0] * widthFactor;
-			uv[1] = uv[1] * heightFactor;
+				// Transform the coord by the view matrix.
+				Vec3ByMatrix43(v, out, gstate.viewMatrix);
+				fogCoef = (v[2] + fog_end) * fog_slope;
 
-			// Transform the coord by the view matrix.
-			Vec3ByMatrix43(v, out, gstate.viewMatrix);
-			fogCoef = (v[2] + fog_end) * fog_slope;
+				// TODO: Write to a flexible buffer, we don't always need all four components.
+				Vec3ByMatrix44(transformed[index].pos, v, projMatrix_.m);
+				transformed[index].fog = fogCoef;
+				memcpy(&transformed[index].uv, uv, 3 * sizeof(float));
+				transformed[index].color0_32 = c0.ToRGBA();
+				transformed[index].color1_32 = c1.ToRGBA();
 
-			// TODO: Write to a flexible buffer, we don't always need all four components.
-			Vec3ByMatrix44(transformed[index].pos, v, projMatrix_.m);
-			transformed[index].fog = fogCoef;
-			memcpy(&transformed[index].uv, uv, 3 * sizeof(float));
-			transformed[index].color0_32 = c0.ToRGBA();
-			transformed[index].color1_32 = c1.ToRGBA();
+				// Vertex depth rounding is done in the shader, to simulate the 16-bit depth buffer.
+			}
+		};
 
-			// Vertex depth rounding is done in the shader, to simulate the 16-bit depth buffer.
+		if (numDecodedVerts >= MIN_VERTS_PER_TRANSFORM_THREAD * 2) {
+			ParallelRangeLoop(&g_threadManager, transformRange, 0, numDecodedVerts, MIN_VERTS_PER_TRANSFORM_THREAD);
+		} else {
+			transformRange(0, numDecodedVerts);
 		}
 	}
 
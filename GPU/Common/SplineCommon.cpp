@@ -19,6 +19,7 @@
 #include "Common/Common.h"
 #include "Common/CPUDetect.h"
 #include "Common/Profiler/Profiler.h"
+#include "Common/Thread/ParallelLoop.h"
 #include "GPU/Common/SplineCommon.h"
 #include "GPU/Common/DrawEngineCommon.h"
 #include "GPU/Common/SoftwareTransformCommon.h"
@@ -331,6 +332,9 @@ void ControlPoints::Convert(const SimpleVertex *const *points, int size) {
 	defcolor = points[0]->color_32;
 }
 
+// Minimum number of output vertices to tessellate per thread.
+static constexpr int MIN_VERTS_PER_TESS_THREAD = 2048;
+
 template<class Surface>
 class SubdivisionSurface {
 public:
@@ -339,66 +343,77 @@ class SubdivisionSurface {
 		const float inv_u = 1.0f / (float)surface.tess_u;
 		const float inv_v = 1.0f / (float)surface.tess_v;
 
-		for (int patch_u = 0; patch_u < surface.num_patches_u; ++patch_u) {
-			const int start_u = surface.GetTessStart(patch_u);
-			for (int patch_v = 0; patch_v < surface.num_patches_v; ++patch_v) {
-				const int start_v = surface.GetTessStart(patch_v);
-
-				// Prepare 4x4 control points to tessellate
-				const int idx = surface.GetPointIndex(patch_u, patch_v);
-				const int idx_v[4] = { idx, idx + surface.num_points_u, idx + surface.num_points_u * 2, idx + surface.num_points_u * 3 };
-				Tessellator<Vec3f> tess_pos(points.pos, idx_v);
-				Tessellator<Vec4f> tess_col(points.col, idx_v);
-				Tessellator<Vec2f> tess_tex(points.tex, idx_v);
-				Tessellator<Vec3f> tess_nrm(points.pos, idx_v);
-
-				for (int tile_u = start_u; tile_u <= surface.tess_u; ++tile_u) {
-					const int index_u = surface.GetIndexU(patch_u, tile_u);
-					const Weight &wu = weights.u[index_u];
-
-					// Pre-tessellate U lines
-					tess_pos.SampleU(wu.basis);
-					if constexpr (sampleCol)
-						tess_col.SampleU(wu.basis);
-					if constexpr (sampleTex)
-						tess_tex.SampleU(wu.basis);
-					if constexpr (sampleNrm)
-						tess_nrm.SampleU(wu.deriv);
-
-					for (int tile_v = start_v; tile_v <= surface.tess_v; ++tile_v) {
-						const int index_v = surface.GetIndexV(patch_v, tile_v);
-						const Weight &wv = weights.v[index_v];
-
-						SimpleVertex &vert = output.vertices[surface.GetIndex(index_u, index_v, patch_u, patch_v)];
-
-						// Tessellate
-						vert.pos = tess_pos.SampleV(wv.basis);
-						if constexpr (sampleCol) {
-							vert.color_32 = tess_col.SampleV(wv.basis).ToRGBA();
-						} else {
-							vert.color_32 = points.defcolor;
-						}
-						if constexpr (sampleTex) {
-							tess_tex.SampleV(wv.basis).Write(vert.uv);
-						} else {
-							// Generate texcoord
-							vert.uv[0] = patch_u + tile_u * inv_u;
-							vert.uv[1] = patch_v + tile_v * inv_v;
-						}
-						if constexpr (sampleNrm) {
-							const Vec3f derivU = tess_nrm.SampleV(wv.basis);
-							const Vec3f derivV = tess_pos.SampleV(wv.deriv);
-
-							vert.nrm = Cross(derivU, derivV).Normalized(useSSE4);
-							if constexpr (patchFacing)
-								vert.nrm *= -1.0f;
-						} else {
-							vert.nrm.SetZero();
-							vert.nrm.z = 1.0f;
+		// Each row of patches writes its own disjoint set of output vertices, so big surfaces can be split across threads.
+		auto tessellateRows = [&](int lower, int upper) {
+			for (int patch_u = lower; patch_u < upper; ++patch_u) {
+				const int start_u = surface.GetTessStart(patch_u);
+				for (int patch_v = 0; patch_v < surface.num_patches_v; ++patch_v) {
+					const int start_v = surface.GetTessStart(patch_v);
+
+					// Prepare 4x4 control points to tessellate
+					const int idx = surface.GetPointIndex(patch_u, patch_v);
+					const int idx_v[4] = { idx, idx + surface.num_points_u, idx + surface.num_points_u * 2, idx + surface.num_points_u * 3 };
+					Tessellator<Vec3f> tess_pos(points.pos, idx_v);
+					Tessellator<Vec4f> tess_col(points.col, idx_v);
+					Tessellator<Vec2f> tess_tex(points.tex, idx_v);
+					Tessellator<Vec3f> tess_nrm(points.pos, idx_v);
+
+					for (int tile_u = start_u; tile_u <= surface.tess_u; ++tile_u) {
+						const int index_u = surface.GetIndexU(patch_u, tile_u);
+						const Weight &wu = weights.u[index_u];
+
+						// Pre-tessellate U lines
+						tess_pos.SampleU(wu.basis);
+						if constexpr (sampleCol)
+							tess_col.SampleU(wu.basis);
+						if constexpr (sampleTex)
+							tess_tex.SampleU(wu.basis);
+						if constexpr (sampleNrm)
+							tess_nrm.SampleU(wu.deriv);
+
+						for (int tile_v = start_v; tile_v <= surface.tess_v; ++tile_v) {
+							const int index_v = surface.GetIndexV(patch_v, tile_v);
+							const Weight &wv = weights.v[index_v];
+
+							SimpleVertex &vert = output.vertices[surface.GetIndex(index_u, index_v, patch_u, patch_v)];
+
+							// Tessellate
+							vert.pos = tess_pos.SampleV(wv.basis);
+							if constexpr (sampleCol) {
+								vert.color_32 = tess_col.SampleV(wv.basis).ToRGBA();
+							} else {
+								vert.color_32 = points.defcolor;
+							}
+							if constexpr (sampleTex) {
+								tess_tex.SampleV(wv.basis).Write(vert.uv);
+							} else {
+								// Generate texcoord
+								vert.uv[0] = patch_u + tile_u * inv_u;
+								vert.uv[1] = patch_v + tile_v * inv_v;
+							}
+							if constexpr (sampleNrm) {
+								const Vec3f derivU = tess_nrm.SampleV(wv.basis);
+								const Vec3f derivV = tess_pos.SampleV(wv.deriv);
+
+								vert.nrm = Cross(derivU, derivV).Normalized(useSSE4);
+								if constexpr (patchFacing)
+									vert.nrm *= -1.0f;
+							} else {
+								vert.nrm.SetZero();
+								vert.nrm.z = 1.0f;
+							}
 						}
 					}
 				}
 			}
+		};
+
+		const int vertsPerPatchRow = surface.num_patches_v * (surface.tess_u + 1) * (surface.tess_v + 1);
+		if (surface.num_patches_u > 1 && vertsPerPatchRow * surface.num_patches_u >= MIN_VERTS_PER_TESS_THREAD * 2) {
+			const int minRows = std::max(1, MIN_VERTS_PER_TESS_THREAD / std::max(vertsPerPatchRow, 1));
+			ParallelRangeLoop(&g_threadManager, tessellateRows, 0, surface.num_patches_u, minRows);
+		} else {
+			tessellateRows(0, surface.num_patches_u);
 		}
 
 		surface.BuildIndex(output.indices, output.count);
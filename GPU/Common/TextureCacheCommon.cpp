@@ -1979,6 +1979,28 @@ CheckAlphaResult TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, G
 	return AlphaSumIsFull(alphaSum, fullAlphaMask) ? CHECKALPHA_FULL : CHECKALPHA_ANY;
 }
 
+const u32 *TextureCacheCommon::GetClut8888ForLevel(GETextureFormat format, int level, int *numEntries) {
+	// Same CLUT sharing rules as DecodeTextureLevel and ReadIndexedTex.
+	int clutSharingOffset;
+	if (format == GE_TFMT_CLUT4) {
+		clutSharingOffset = gstate.isClutSharedForMipmaps() ? 0 : level * 16;
+	} else {
+		const bool mipmapShareClut = gstate.isClutSharedForMipmaps() || gstate.getClutLoadBlocks() != 0x40;
+		clutSharingOffset = mipmapShareClut ? 0 : (level & 1) * 256;
+	}
+
+	GEPaletteFormat palFormat = gstate.getClutPaletteFormat();
+	if (palFormat == GE_CMODE_32BIT_ABGR8888) {
+		// transformClutIndex wraps at 256 entries for 32-bit CLUTs.
+		*numEntries = 256;
+		return GetCurrentRawClut<u32>() + clutSharingOffset;
+	}
+
+	*numEntries = 512;
+	ConvertFormatToRGBA8888(palFormat, expandClut_, GetCurrentRawClut<u16>() + clutSharingOffset, 512);
+	return expandClut_;
+}
+
 CheckAlphaResult TextureCacheCommon::ReadIndexedTex(u8 *out, int outPitch, int level, const u8 *texptr, int bytesPerIndex, int bufw, bool reverseColors, bool expandTo32Bit) {
 	int w = gstate.getTextureWidth(level);
 	int h = gstate.getTextureHeight(level);
@@ -2728,7 +2750,9 @@ bool TextureCacheCommon::PrepareBuildTexture(BuildTexturePlan &plan, TexCacheEnt
 	gpuStats.numTexturesDecoded++;
 
 	// For the estimate, we assume cluts always point to 8888 for simplicity.
-	cacheSizeEstimate_ += EstimateTexMemoryUsage(entry);
+	const u32 memUsage = EstimateTexMemoryUsage(entry);
+	cacheSizeEstimate_ += memUsage;
+	gpuStats.numTextureDataBytesDecoded += memUsage;
 
 	plan.badMipSizes = false;
 	// maxLevel here is the max level to upload. Not the count.
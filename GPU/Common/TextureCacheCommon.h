@@ -23,6 +23,7 @@
 
 #include "Common/CommonTypes.h"
 #include "Common/MemoryUtil.h"
+#include "Common/Data/Collections/Hashmaps.h"
 #include "Core/System.h"
 #include "GPU/GPU.h"
 #include "GPU/Common/GPUDebugInterface.h"
@@ -237,9 +238,64 @@ struct TexCacheEntry {
 	static u64 CacheKey(u32 addr, u8 format, u16 dim, u32 cluthash);
 };
 
-// Can't be unordered_map, we use lower_bound ... although for some reason that (used to?) compiles on MSVC.
-// Would really like to replace this with DenseHashMap but can't as long as we need lower_bound.
-typedef std::map<u64, std::unique_ptr<TexCacheEntry>> TexCache;
+// The texture cache. The address is in the top bits of the cache key, so the ordered map doubles as an
+// address index: invalidation and framebuffer matching walk key ranges with lower_bound/upper_bound.
+// Exact lookups happen on every texture change though, so those go through a hash index of the map's
+// (stable) iterators instead of walking the tree.
+class TexCache {
+public:
+	typedef std::map<u64, std::unique_ptr<TexCacheEntry>> Map;
+	typedef Map::iterator iterator;
+	typedef Map::const_iterator const_iterator;
+
+	TexCache() : index_(1024) {}
+
+	iterator begin() { return entries_.begin(); }
+	iterator end() { return entries_.end(); }
+	const_iterator begin() const { return entries_.begin(); }
+	const_iterator end() const { return entries_.end(); }
+	iterator lower_bound(u64 key) { return entries_.lower_bound(key); }
+	iterator upper_bound(u64 key) { return entries_.upper_bound(key); }
+	size_t size() const { return entries_.size(); }
+	bool empty() const { return entries_.empty(); }
+
+	iterator find(u64 key) {
+		iterator it;
+		if (index_.Get(key, &it))
+			return it;
+		return entries_.end();
+	}
+	const_iterator find(u64 key) const {
+		iterator it;
+		if (index_.Get(key, &it))
+			return it;
+		return entries_.end();
+	}
+
+	std::unique_ptr<TexCacheEntry> &operator[](u64 key) {
+		iterator it;
+		if (!index_.Get(key, &it)) {
+			it = entries_.emplace(key, nullptr).first;
+			index_.Insert(key, it);
+		}
+		return it->second;
+	}
+
+	iterator erase(iterator it) {
+		index_.Remove(it->first);
+		index_.Maintain();
+		return entries_.erase(it);
+	}
+
+	void clear() {
+		entries_.clear();
+		index_.Clear();
+	}
+
+private:
+	Map entries_;
+	DenseHashMap<u64, iterator> index_;
+};
 
 // Urgh.
 #ifdef IGNORE
@@ -409,6 +465,9 @@ class TextureCacheCommon {
 	CheckAlphaResult DecodeTextureLevel(u8 *out, int outPitch, GETextureFormat format, GEPaletteFormat clutformat, uint32_t texaddr, int level, int bufw, TexDecodeFlags flags);
 	static void UnswizzleFromMem(u32 *dest, u32 destPitch, const u8 *texptr, u32 bufw, u32 height, u32 bytesPerPixel);
 	CheckAlphaResult ReadIndexedTex(u8 *out, int outPitch, int level, const u8 *texptr, int bytesPerIndex, int bufw, bool reverseColors, bool expandTo32Bit);
+	// Returns the CLUT used by a CLUT4/CLUT8 level, expanded to 8888, for backends that do the lookup on the GPU.
+	// numEntries is how many entries a transformed index can reach.
+	const u32 *GetClut8888ForLevel(GETextureFormat format, int level, int *numEntries);
 	ReplacedTexture *FindReplacement(TexCacheEntry *entry, int *w, int *h, int *d);
 	void PollReplacement(TexCacheEntry *entry, int *w, int *h, int *d);
 
@@ -470,7 +529,8 @@ class TextureCacheCommon {
 		gpuStats.numTextureDataBytesHashed += sizeInRAM;
 
 		if (Memory::IsValidAddress(addr + sizeInRAM)) {
-			return StableQuickTexHash(checkp, sizeInRAM);
+			// The replacer handles its own (stable) hashing above, so this one is only kept in memory.
+			return FastQuickTexHash(checkp, sizeInRAM);
 		} else {
 			return 0;
 		}
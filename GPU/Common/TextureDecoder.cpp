@@ -20,6 +20,7 @@
 #include "ext/xxhash.h"
 
 #include "Common/Common.h"
+#include "Common/CPUDetect.h"
 #include "Common/Log.h"
 #include "Common/Math/SIMDHeaders.h"
 
@@ -81,6 +82,43 @@ static u32 QuickTexHashSSE2(const void *checkp, u32 size) {
 
 	return check;
 }
+
+#if defined(_MSC_VER) || defined(__GNUC__)
+#define QUICKTEXHASH_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#define AVX2_TARGET
+#else
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+// Same construction as QuickTexHashSSE2, but two 128-bit lanes wide, so it runs about twice as fast.
+// The values differ from the stable hash, so this is only usable for hashes that are never persisted.
+AVX2_TARGET static u32 QuickTexHashAVX2(const void *checkp, u32 size) {
+	__m256i cursor = _mm256_setzero_si256();
+	__m256i cursor2 = _mm256_set_epi16(
+		0x0001U, 0x0083U, 0x4309U, 0x4d9bU, 0xb651U, 0x4b73U, 0x9bd9U, 0xc00bU,
+		0x0001U, 0x0083U, 0x4309U, 0x4d9bU, 0xb651U, 0x4b73U, 0x9bd9U, 0xc00bU);
+	__m256i update = _mm256_set1_epi16(0x2455U);
+	const __m256i *p = (const __m256i *)checkp;
+	for (u32 i = 0; i < size / 32; i += 4) {
+		__m256i chunk = _mm256_mullo_epi16(_mm256_loadu_si256(&p[i]), cursor2);
+		cursor = _mm256_add_epi16(cursor, chunk);
+		cursor = _mm256_xor_si256(cursor, _mm256_loadu_si256(&p[i + 1]));
+		cursor = _mm256_add_epi32(cursor, _mm256_loadu_si256(&p[i + 2]));
+		chunk = _mm256_mullo_epi16(_mm256_loadu_si256(&p[i + 3]), cursor2);
+		cursor = _mm256_xor_si256(cursor, chunk);
+		cursor2 = _mm256_add_epi16(cursor2, update);
+	}
+	cursor = _mm256_add_epi32(cursor, cursor2);
+	// Fold the two lanes, then add the four parts into the low i32.
+	__m128i folded = _mm_add_epi32(_mm256_castsi256_si128(cursor), _mm256_extracti128_si256(cursor, 1));
+	folded = _mm_add_epi32(folded, _mm_srli_si128(folded, 8));
+	folded = _mm_add_epi32(folded, _mm_srli_si128(folded, 4));
+	return _mm_cvtsi128_si32(folded);
+}
+#endif
+
 #endif
 
 #if PPSSPP_ARCH(ARM_NEON)
@@ -283,6 +321,62 @@ u32 StableQuickTexHash(const void *checkp, u32 size) {
 #endif
 }
 
+u32 FastQuickTexHash(const void *checkp, u32 size) {
+#ifdef QUICKTEXHASH_AVX2
+	if (cpu_info.bAVX2 && (size & 0x7f) == 0) {
+		return QuickTexHashAVX2(checkp, size);
+	}
+#endif
+	return StableQuickTexHash(checkp, size);
+}
+
+// Two packed u16s at a time, without carrying between them.
+static inline u32 Add16x2(u32 a, u32 b) {
+	return ((a + b) & 0xFFFF) | (((a >> 16) + (b >> 16)) << 16);
+}
+
+static inline u32 Mul16x2(u32 a, u32 b) {
+	return (((a & 0xFFFF) * (b & 0xFFFF)) & 0xFFFF) | (((a >> 16) * (b >> 16)) << 16);
+}
+
+u32 FastQuickTexHashGeneric(const void *checkp, u32 size) {
+	if ((size & 0x7f) != 0)
+		return StableQuickTexHash(checkp, size);
+
+	// Each 32 byte row is two independent 16 byte lanes, just like the 128-bit halves of the AVX2 registers.
+	static const u32 cursor2Initial[4] = { 0x9bd9c00bU, 0xb6514b73U, 0x43094d9bU, 0x00010083U };
+	u32 cursor[2][4]{};
+	u32 cursor2[2][4];
+	for (int lane = 0; lane < 2; ++lane)
+		memcpy(cursor2[lane], cursor2Initial, sizeof(cursor2Initial));
+
+	const u8 *p = (const u8 *)checkp;
+	for (u32 i = 0; i < size / 32; i += 4) {
+		for (int lane = 0; lane < 2; ++lane) {
+			u32 rows[4][4];
+			for (int r = 0; r < 4; ++r)
+				memcpy(rows[r], p + (i + r) * 32 + lane * 16, 16);
+			u32 *c = cursor[lane];
+			const u32 *c2 = cursor2[lane];
+			for (int j = 0; j < 4; ++j) {
+				c[j] = Add16x2(c[j], Mul16x2(rows[0][j], c2[j]));
+				c[j] ^= rows[1][j];
+				c[j] += rows[2][j];
+				c[j] ^= Mul16x2(rows[3][j], c2[j]);
+			}
+			for (int j = 0; j < 4; ++j)
+				cursor2[lane][j] = Add16x2(cursor2[lane][j], 0x24552455U);
+		}
+	}
+
+	u32 check = 0;
+	for (int lane = 0; lane < 2; ++lane) {
+		for (int j = 0; j < 4; ++j)
+			check += cursor[lane][j] + cursor2[lane][j];
+	}
+	return check;
+}
+
 void DoSwizzleTex16(const u32 *ysrcp, u8 *texptr, int bxc, int byc, u32 pitch) {
 	// ysrcp is in 32-bits, so this is convenient.
 	const u32 pitchBy32 = pitch >> 2;
@@ -36,6 +36,11 @@ void DoSwizzleTex16(const u32 *ysrcp, u8 *texptr, int bxc, int byc, u32 pitch);
 void DoUnswizzleTex16(const u8 *texptr, u32 *ydestp, int bxc, int byc, u32 pitch);
 
 u32 StableQuickTexHash(const void *checkp, u32 size);
+// Uses the widest kernel the CPU supports. Results can differ between CPUs, so never store these
+// anywhere (like texture replacement ini files) - use StableQuickTexHash for that.
+u32 FastQuickTexHash(const void *checkp, u32 size);
+// Plain C version of the wide hash FastQuickTexHash uses when the CPU has AVX2. Slow, for testing.
+u32 FastQuickTexHashGeneric(const void *checkp, u32 size);
 
 // outMask is an in/out parameter.
 void CopyAndSumMask16(u16 *dst, const u16 *src, int width, u32 *outMask);
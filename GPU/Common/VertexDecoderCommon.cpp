@@ -25,6 +25,7 @@
 #include "Common/Data/Convert/ColorConv.h"
 #include "Common/Log.h"
 #include "Common/LogReporting.h"
+#include "Common/Thread/ParallelLoop.h"
 #include "Core/Config.h"
 #include "Core/ConfigValues.h"
 #include "Core/HDRemaster.h"
@@ -45,6 +46,9 @@ static const u8 wtsize[4] = { 0, 1, 2, 4 }, wtalign[4] = { 0, 1, 2, 4 };
 
 static constexpr bool validateJit = false;
 
+// Below this many vertices per thread, spinning up workers for a decode costs more than it saves.
+static constexpr int MIN_VERTS_PER_DECODE_THREAD = 4096;
+
 // When software skinning. This array is only used when non-jitted - when jitted, the matrix
 // is kept in registers.
 alignas(16) static float skinMatrix[12];
@@ -1353,6 +1357,20 @@ void VertexDecoder::DecodeVerts(u8 *decodedptr, const void *verts, const UVScale
 
 	if (jitted_ && !validateJit) {
 		// We've compiled the steps into optimized machine code, so just jump!
+		// Large batches are split into disjoint slices across threads. Software skinning (shared bone scratch)
+		// and through mode (UV bounds accumulation) write global state, so those stay on this thread.
+		// The other jits only ever store false to vertexFullAlpha, so slices racing on it are harmless.
+		// The x86-32 jit does a read-modify-write AND on it per vertex and could lose a clear, so it stays serial.
+#if !PPSSPP_ARCH(X86)
+		if (count >= MIN_VERTS_PER_DECODE_THREAD * 2 && !skinInDecode && !throughmode) {
+			const JittedVertexDecoder jitted = jitted_;
+			const int srcSize = size;
+			ParallelRangeLoop(&g_threadManager, [=](int l, int h) {
+				jitted(startPtr + l * srcSize, decodedptr + l * stride, h - l, uvScaleOffset);
+			}, 0, count, MIN_VERTS_PER_DECODE_THREAD);
+			return;
+		}
+#endif
 		jitted_(startPtr, decodedptr, count, uvScaleOffset);
 	} else {
 		const u8 *ptr = startPtr;
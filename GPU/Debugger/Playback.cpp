@@ -872,8 +872,13 @@ static u32 LoadReplay(const std::string &filename) {
 	lastExecPushbuf.resize(bufsz);
 
 	bool truncated = false;
-	truncated = truncated || !ReadCompressed(fp, lastExecCommands.data(), sizeof(Command) * sz, header.version);
-	truncated = truncated || !ReadCompressed(fp, lastExecPushbuf.data(), bufsz, header.version);
+	if (header.version >= 7) {
+		truncated = truncated || !ReadCompressed(fp, lastExecPushbuf.data(), bufsz, header.version);
+		truncated = truncated || !ReadCompressed(fp, lastExecCommands.data(), sizeof(Command) * sz, header.version);
+	} else {
+		truncated = truncated || !ReadCompressed(fp, lastExecCommands.data(), sizeof(Command) * sz, header.version);
+		truncated = truncated || !ReadCompressed(fp, lastExecPushbuf.data(), bufsz, header.version);
+	}
 
 	pspFileSystem.CloseFile(fp);
 
@@ -48,16 +48,28 @@
 
 namespace GPURecord {
 
+// The pushbuf is compressed to the file while recording, keeping this much of the end to find repeats in.
+static const u32 PUSHBUF_WINDOW = 16 * 1024 * 1024;
+// Flushed in steps of at least this size, so we don't move the window around too often.
+static const u32 PUSHBUF_FLUSH_SIZE = 8 * 1024 * 1024;
+static const size_t COMMANDS_FLUSH_COUNT = 4096;
+// Offsets in the file are relative to the start of the whole pushbuf, so keep this alignment when flushing.
+static const u32 PUSHBUF_FLUSH_ALIGN = 16;
+
+Recorder::~Recorder() {
+	if (file) {
+		// Never finished, so it's not worth keeping.
+		fclose(file);
+		file = nullptr;
+		File::Delete(filename);
+	}
+	CloseFile();
+}
+
 void Recorder::FlushRegisters() {
 	if (!lastRegisters.empty()) {
-		Command last{ CommandType::REGISTERS };
-		last.ptr = (u32)pushbuf.size();
-		last.sz = (u32)(lastRegisters.size() * sizeof(u32));
-		pushbuf.resize(pushbuf.size() + last.sz);
-		memcpy(pushbuf.data() + last.ptr, lastRegisters.data(), last.sz);
+		EmitCommand(CommandType::REGISTERS, lastRegisters.data(), (u32)(lastRegisters.size() * sizeof(u32)));
 		lastRegisters.clear();
-
-		commands.push_back(last);
 	}
 }
 
@@ -125,12 +137,54 @@ void Recorder::DirtyDrawnVRAM() {
 	DirtyVRAM(gstate.getFrameBufAddress(), bytes, DirtyVRAMFlag::DRAWN);
 }
 
+static bool CompressStream(ZSTD_CCtx *ctx, const void *p, size_t sz, bool finish, std::vector<u8> &dest) {
+	ZSTD_inBuffer in{ p, sz, 0 };
+	const ZSTD_EndDirective mode = finish ? ZSTD_e_end : ZSTD_e_continue;
+	size_t remaining = 0;
+	do {
+		size_t pos = dest.size();
+		dest.resize(pos + ZSTD_CStreamOutSize());
+		ZSTD_outBuffer out{ dest.data() + pos, ZSTD_CStreamOutSize(), 0 };
+		remaining = ZSTD_compressStream2(ctx, &out, &in, mode);
+		dest.resize(pos + out.pos);
+		if (ZSTD_isError(remaining)) {
+			ERROR_LOG(Log::G3D, "Failed to compress recording: %s", ZSTD_getErrorName(remaining));
+			return false;
+		}
+	} while (finish ? remaining != 0 : in.pos < in.size);
+	return true;
+}
+
 bool Recorder::BeginRecording() {
 	if (PSP_CoreParameter().fileType == IdentifiedFileType::PPSSPP_GE_DUMP) {
 		// Can't record a GE dump.
 		return false;
 	}
 
+	// Create the file now, the data is compressed into it as we go.
+	filename = GenRecordingFilename();
+	NOTICE_LOG(Log::G3D, "Recording filename: %s", filename.c_str());
+	file = File::OpenCFile(filename, "wb");
+	if (!file) {
+		ERROR_LOG(Log::G3D, "Unable to open recording file for write: %s", filename.c_str());
+		nextFrame = false;
+		RunCallback(Path());
+		return false;
+	}
+
+	Header header{};
+	memcpy(header.magic, HEADER_MAGIC, sizeof(header.magic));
+	header.version = VERSION;
+	strncpy(header.gameID, g_paramSFO.GetDiscID().c_str(), sizeof(header.gameID));
+	// The counts and the compressed pushbuf size are filled in at the end.
+	const u32 placeholders[3]{};
+	writeFailed = fwrite(&header, sizeof(header), 1, file) != 1 || fwrite(placeholders, sizeof(placeholders), 1, file) != 1;
+
+	pushbufStream = ZSTD_createCCtx();
+	ZSTD_CCtx_setParameter(pushbufStream, ZSTD_c_compressionLevel, 6);
+	commandStream = ZSTD_createCCtx();
+	ZSTD_CCtx_setParameter(commandStream, ZSTD_c_compressionLevel, 6);
+
 	active = true;
 	nextFrame = false;
 	lastTextures.clear();
@@ -138,65 +192,90 @@ bool Recorder::BeginRecording() {
 	flipLastAction = gpuStats.numFlips;
 	flipFinishAt = -1;
 
-	u32 ptr = (u32)pushbuf.size();
-	u32 sz = 512 * 4;
-	pushbuf.resize(pushbuf.size() + sz);
-	gstate.Save((u32_le *)(pushbuf.data() + ptr));
-	commands.push_back({ CommandType::INIT, sz, ptr });
+	u32_le registers[512];
+	gstate.Save(registers);
+	EmitCommand(CommandType::INIT, registers, sizeof(registers));
 	lastVRAM.resize(2 * 1024 * 1024);
 
 	// Also save the initial CLUT.
 	GPUDebugBuffer clut;
 	if (gpuDebug->GetCurrentClut(clut)) {
-		sz = clut.GetStride() * clut.PixelSize();
+		u32 sz = clut.GetStride() * clut.PixelSize();
 		_assert_msg_(sz == 1024, "CLUT should be 1024 bytes");
-		ptr = (u32)pushbuf.size();
-		pushbuf.resize(pushbuf.size() + sz);
-		memcpy(pushbuf.data() + ptr, clut.GetData(), sz);
-		commands.push_back({ CommandType::CLUT, sz, ptr });
+		EmitCommand(CommandType::CLUT, clut.GetData(), sz);
 	}
 
 	DirtyAllVRAM(DirtyVRAMFlag::DIRTY);
 	return true;
 }
 
-static void WriteCompressed(FILE *fp, const void *p, size_t sz) {
-	size_t compressed_size = ZSTD_compressBound(sz);
-	u8 *compressed = new u8[compressed_size];
-	compressed_size = ZSTD_compress(compressed, compressed_size, p, sz, 6);
+void Recorder::FlushToFile(bool finish) {
+	if (commands.size() >= COMMANDS_FLUSH_COUNT || finish) {
+		if (!writeFailed)
+			writeFailed = !CompressStream(commandStream, commands.data(), commands.size() * sizeof(Command), finish, compressedCommands);
+		commandsFlushed += (u32)commands.size();
+		commands.clear();
+	}
 
-	u32 write_size = (u32)compressed_size;
-	fwrite(&write_size, sizeof(write_size), 1, fp);
-	fwrite(compressed, compressed_size, 1, fp);
+	if (pushbuf.size() >= PUSHBUF_WINDOW + PUSHBUF_FLUSH_SIZE || finish) {
+		size_t bytes = finish ? pushbuf.size() : (pushbuf.size() - PUSHBUF_WINDOW) & ~(size_t)(PUSHBUF_FLUSH_ALIGN - 1);
+		compressedChunk.clear();
+		if (!writeFailed && CompressStream(pushbufStream, pushbuf.data(), bytes, finish, compressedChunk)) {
+			writeFailed = fwrite(compressedChunk.data(), 1, compressedChunk.size(), file) != compressedChunk.size();
+			pushbufCompressedSize += (u32)compressedChunk.size();
+		} else {
+			writeFailed = true;
+		}
 
-	delete[] compressed;
+		pushbuf.erase(pushbuf.begin(), pushbuf.begin() + bytes);
+		pushbufFlushed += (u32)bytes;
+		// Can't compare against these anymore.
+		lastTextures.erase(std::remove_if(lastTextures.begin(), lastTextures.end(), [&](u32 ptr) {
+			return ptr < pushbufFlushed;
+		}), lastTextures.end());
+	}
 }
 
-Path Recorder::WriteRecording() {
-	FlushRegisters();
-
-	const Path filename = GenRecordingFilename();
-
-	NOTICE_LOG(Log::G3D, "Recording filename: %s", filename.c_str());
+void Recorder::CloseFile() {
+	ZSTD_freeCCtx(pushbufStream);
+	pushbufStream = nullptr;
+	ZSTD_freeCCtx(commandStream);
+	commandStream = nullptr;
 
-	FILE *fp = File::OpenCFile(filename, "wb");
-	Header header{};
-	memcpy(header.magic, HEADER_MAGIC, sizeof(header.magic));
-	header.version = VERSION;
-	strncpy(header.gameID, g_paramSFO.GetDiscID().c_str(), sizeof(header.gameID));
-	fwrite(&header, sizeof(header), 1, fp);
-
-	u32 sz = (u32)commands.size();
-	fwrite(&sz, sizeof(sz), 1, fp);
-	u32 bufsz = (u32)pushbuf.size();
-	fwrite(&bufsz, sizeof(bufsz), 1, fp);
-
-	WriteCompressed(fp, commands.data(), commands.size() * sizeof(Command));
-	WriteCompressed(fp, pushbuf.data(), bufsz);
+	pushbuf.clear();
+	pushbufFlushed = 0;
+	commands.clear();
+	commandsFlushed = 0;
+	hasDrawCommands = false;
+	compressedChunk.clear();
+	compressedChunk.shrink_to_fit();
+	pushbufCompressedSize = 0;
+	compressedCommands.clear();
+	compressedCommands.shrink_to_fit();
+	writeFailed = false;
+}
+
+void Recorder::RunCallback(const Path &filename) {
+	// Held while calling, so ClearCallback() can't return while the callback is still using its owner.
+	std::lock_guard<std::mutex> guard(callbackLock);
+	if (writeCallback)
+		writeCallback(filename);
+	writeCallback = nullptr;
+}
 
-	fclose(fp);
+void Recorder::AddCommand(const Command &cmd) {
+	commands.push_back(cmd);
+	if (cmd.type != CommandType::INIT && cmd.type != CommandType::DISPLAY)
+		hasDrawCommands = true;
+	FlushToFile(false);
+}
 
-	return filename;
+Command Recorder::EmitCommand(CommandType t, const void *p, u32 sz) {
+	Command cmd{ t, sz, pushbufFlushed + (u32)pushbuf.size() };
+	pushbuf.resize(pushbuf.size() + sz);
+	memcpy(pushbuf.data() + pushbuf.size() - sz, p, sz);
+	AddCommand(cmd);
+	return cmd;
 }
 
 static void GetVertDataSizes(int vcount, const void *indices, u32 &vbytes, u32 &ibytes) {
@@ -290,23 +369,24 @@ Command Recorder::EmitCommandWithRAM(CommandType t, const void *p, u32 sz, u32 a
 		}
 
 		if (prev) {
-			cmd.ptr = (u32)(prev - pushbuf.data());
+			cmd.ptr = pushbufFlushed + (u32)(prev - pushbuf.data());
 		} else {
-			cmd.ptr = (u32)pushbuf.size();
+			u32 ptr = (u32)pushbuf.size();
 			int pad = 0;
-			if (cmd.ptr & (align - 1)) {
-				pad = align - (cmd.ptr & (align - 1));
-				cmd.ptr += pad;
+			if (ptr & (align - 1)) {
+				pad = align - (ptr & (align - 1));
+				ptr += pad;
 			}
 			pushbuf.resize(pushbuf.size() + sz + pad);
 			if (pad) {
-				memset(pushbuf.data() + cmd.ptr - pad, 0, pad);
+				memset(pushbuf.data() + ptr - pad, 0, pad);
 			}
-			memcpy(pushbuf.data() + cmd.ptr, p, sz);
+			memcpy(pushbuf.data() + ptr, p, sz);
+			cmd.ptr = pushbufFlushed + ptr;
 		}
 	}
 
-	commands.push_back(cmd);
+	AddCommand(cmd);
 
 	return cmd;
 }
@@ -431,12 +511,12 @@ void Recorder::EmitTextureData(int level, u32 texaddr) {
 
 		// Dumps are huge - let's try to find this already emitted.
 		for (u32 prevptr : lastTextures) {
-			if (pushbuf.size() < prevptr + bytes) {
+			if (prevptr < pushbufFlushed || pushbufFlushed + pushbuf.size() < prevptr + bytes) {
 				continue;
 			}
 
-			if (memcmp(pushbuf.data() + prevptr, p, bytes) == 0) {
-				commands.push_back({ type, bytes, prevptr });
+			if (memcmp(pushbuf.data() + prevptr - pushbufFlushed, p, bytes) == 0) {
+				AddCommand({ type, bytes, prevptr });
 				// Okay, that was easy.  Bail out.
 				return;
 			}
@@ -543,10 +623,7 @@ void Recorder::EmitClut(u32 op) {
 			ClutAddrData data{ addr, flags };
 
 			FlushRegisters();
-			Command cmd{ CommandType::CLUTADDR, sizeof(data), (u32)pushbuf.size() };
-			pushbuf.resize(pushbuf.size() + sizeof(data));
-			memcpy(pushbuf.data() + cmd.ptr, &data, sizeof(data));
-			commands.push_back(cmd);
+			EmitCommand(CommandType::CLUTADDR, &data, sizeof(data));
 
 			if ((flags & 2) == 0)
 				UpdateLastVRAM(addr, bytes);
@@ -577,7 +654,10 @@ bool Recorder::RecordNextFrame(const std::function<void(const Path &)> callback)
 	if (!nextFrame) {
 		flipLastAction = gpuStats.numFlips;
 		flipFinishAt = -1;
-		writeCallback = callback;
+		{
+			std::lock_guard<std::mutex> guard(callbackLock);
+			writeCallback = callback;
+		}
 		nextFrame = true;
 		return true;
 	}
@@ -590,21 +670,41 @@ void Recorder::FinishRecording() {
 		return;
 	}
 
-	Path filename = WriteRecording();
-	commands.clear();
-	pushbuf.clear();
-	lastVRAM.clear();
+	FlushRegisters();
+	FlushToFile(true);
+
+	if (!writeFailed) {
+		// The commands go after the pushbuf, now that we have them all.
+		u32 commandsSize = (u32)compressedCommands.size();
+		writeFailed = fwrite(&commandsSize, sizeof(commandsSize), 1, file) != 1;
+		writeFailed = writeFailed || fwrite(compressedCommands.data(), 1, commandsSize, file) != commandsSize;
+
+		const u32 sizes[3]{ commandsFlushed, pushbufFlushed, pushbufCompressedSize };
+		writeFailed = writeFailed || fseek(file, sizeof(Header), SEEK_SET) != 0;
+		writeFailed = writeFailed || fwrite(sizes, sizeof(sizes), 1, file) != 1;
+	}
+	if (fclose(file) != 0)
+		writeFailed = true;
+	file = nullptr;
+
+	const bool success = !writeFailed;
+	if (success) {
+		NOTICE_LOG(Log::G3D, "Recording written: %s", filename.c_str());
+	} else {
+		ERROR_LOG(Log::G3D, "Failed to write recording: %s", filename.c_str());
+		File::Delete(filename);
+	}
+
+	CloseFile();
 
 	NOTICE_LOG(Log::System, "Recording finished");
 	active = false;
 	flipLastAction = gpuStats.numFlips;
 	flipFinishAt = -1;
 	lastEdramTrans = 0x400;
+	lastVRAM.clear();
 
-	if (writeCallback) {
-		writeCallback(filename);
-	}
-	writeCallback = nullptr;
+	RunCallback(success ? filename : Path());
 }
 
 void Recorder::CheckEdramTrans() {
@@ -617,10 +717,7 @@ void Recorder::CheckEdramTrans() {
 	lastEdramTrans = value;
 
 	FlushRegisters();
-	Command cmd{ CommandType::EDRAMTRANS, sizeof(value), (u32)pushbuf.size() };
-	pushbuf.resize(pushbuf.size() + sizeof(value));
-	memcpy(pushbuf.data() + cmd.ptr, &value, sizeof(value));
-	commands.push_back(cmd);
+	EmitCommand(CommandType::EDRAMTRANS, &value, sizeof(value));
 }
 
 void Recorder::NotifyCommand(u32 pc) {
@@ -685,10 +782,7 @@ void Recorder::NotifyMemcpy(u32 dest, u32 src, u32 sz) {
 	CheckEdramTrans();
 	if (Memory::IsVRAMAddress(dest)) {
 		FlushRegisters();
-		Command cmd{ CommandType::MEMCPYDEST, sizeof(dest), (u32)pushbuf.size() };
-		pushbuf.resize(pushbuf.size() + sizeof(dest));
-		memcpy(pushbuf.data() + cmd.ptr, &dest, sizeof(dest));
-		commands.push_back(cmd);
+		EmitCommand(CommandType::MEMCPYDEST, &dest, sizeof(dest));
 
 		sz = Memory::ValidSize(dest, sz);
 		if (sz != 0) {
@@ -716,10 +810,7 @@ void Recorder::NotifyMemset(u32 dest, int v, u32 sz) {
 		MemsetCommand data{ dest, v, sz };
 
 		FlushRegisters();
-		Command cmd{ CommandType::MEMSET, sizeof(data), (u32)pushbuf.size() };
-		pushbuf.resize(pushbuf.size() + sizeof(data));
-		memcpy(pushbuf.data() + cmd.ptr, &data, sizeof(data));
-		commands.push_back(cmd);
+		EmitCommand(CommandType::MEMSET, &data, sizeof(data));
 		ClearLastVRAM(dest, v, sz);
 		DirtyVRAM(dest, sz, DirtyVRAMFlag::CLEAN);
 	}
@@ -731,22 +822,8 @@ void Recorder::NotifyUpload(u32 dest, u32 sz) {
 }
 
 bool Recorder::HasDrawCommands() const {
-	if (commands.empty())
-		return false;
-
-	for (const Command &cmd : commands) {
-		switch (cmd.type) {
-		case CommandType::INIT:
-		case CommandType::DISPLAY:
-			continue;
-
-		default:
-			return true;
-		}
-	}
-
-	// Only init and display commands, keep going.
-	return false;
+	// Only init and display commands means keep going.
+	return hasDrawCommands;
 }
 
 void Recorder::NotifyDisplay(u32 framebuf, int stride, int fmt) {
@@ -771,12 +848,7 @@ void Recorder::NotifyDisplay(u32 framebuf, int stride, int fmt) {
 	DisplayBufData disp{ { framebuf }, stride, fmt };
 
 	FlushRegisters();
-	u32 ptr = (u32)pushbuf.size();
-	u32 sz = (u32)sizeof(disp);
-	pushbuf.resize(pushbuf.size() + sz);
-	memcpy(pushbuf.data() + ptr, &disp, sz);
-
-	commands.push_back({ CommandType::DISPLAY, sz, ptr });
+	EmitCommand(CommandType::DISPLAY, &disp, sizeof(disp));
 
 	if (writePending) {
 		NOTICE_LOG(Log::System, "Recording complete on display");
@@ -800,12 +872,7 @@ void Recorder::NotifyBeginFrame() {
 		__DisplayGetFramebuf(&disp.topaddr, &disp.linesize, &disp.pixelFormat, 0);
 
 		FlushRegisters();
-		u32 ptr = (u32)pushbuf.size();
-		u32 sz = (u32)sizeof(disp);
-		pushbuf.resize(pushbuf.size() + sz);
-		memcpy(pushbuf.data() + ptr, &disp, sz);
-
-		commands.push_back({ CommandType::DISPLAY, sz, ptr });
+		EmitCommand(CommandType::DISPLAY, &disp, sizeof(disp));
 
 		FinishRecording();
 	}
@@ -17,15 +17,18 @@
 
 #pragma once
 
+#include <cstdio>
 #include <functional>
 #include <atomic>
+#include <mutex>
 #include <vector>
 #include <set>
 
 #include "Common/CommonTypes.h"
+#include "Common/File/Path.h"
 #include "GPU/Debugger/RecordFormat.h"
 
-class Path;
+typedef struct ZSTD_CCtx_s ZSTD_CCtx;
 
 namespace GPURecord {
 
@@ -42,6 +45,8 @@ enum class DirtyVRAMFlag : uint8_t {
 
 class Recorder {
 public:
+	~Recorder();
+
 	bool IsActive() const {
 		return active;
 	}
@@ -50,7 +55,8 @@ class Recorder {
 	}
 	bool RecordNextFrame(const std::function<void(const Path &)> callback);
 	void ClearCallback() {
-		// Not super thread safe..
+		// Waits for the callback, if it's running right now.
+		std::lock_guard<std::mutex> guard(callbackLock);
 		writeCallback = nullptr;
 	}
 
@@ -68,12 +74,16 @@ class Recorder {
 	void DirtyDrawnVRAM();
 
 	bool BeginRecording();
-	Path WriteRecording();
 
 	bool HasDrawCommands() const;
 	void CheckEdramTrans();
 	void FinishRecording();
+	void FlushToFile(bool finish);
+	void CloseFile();
+	void RunCallback(const Path &filename);
 
+	void AddCommand(const Command &cmd);
+	Command EmitCommand(CommandType t, const void *p, u32 sz);
 	Command EmitCommandWithRAM(CommandType t, const void *p, u32 sz, u32 align);
 
 	void UpdateLastVRAM(u32 addr, u32 bytes);
@@ -95,9 +105,23 @@ class Recorder {
 	int flipFinishAt = -1;
 	uint32_t lastEdramTrans = 0x400;
 	std::function<void(const Path &)> writeCallback;
+	std::mutex callbackLock;
 
+	// Only the most recent part of the pushbuf is kept, the rest has been compressed to the file.
 	std::vector<u8> pushbuf;
+	u32 pushbufFlushed = 0;
 	std::vector<Command> commands;
+	u32 commandsFlushed = 0;
+	bool hasDrawCommands = false;
+
+	Path filename;
+	FILE *file = nullptr;
+	bool writeFailed = false;
+	ZSTD_CCtx *pushbufStream = nullptr;
+	ZSTD_CCtx *commandStream = nullptr;
+	std::vector<u8> compressedChunk;
+	u32 pushbufCompressedSize = 0;
+	std::vector<u8> compressedCommands;
 	std::vector<u32> lastRegisters;
 	std::vector<u32> lastTextures;
 	std::set<u32> lastRenderTargets;
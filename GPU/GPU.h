@@ -90,6 +90,7 @@ struct GPUStatistics {
 		numBBOXJumps = 0;
 		numPlaneUpdates = 0;
 		numTexturesDecoded = 0;
+		numTextureDataBytesDecoded = 0;
 		numFramebufferEvaluations = 0;
 		numFBOsCreated = 0;
 		numBlockingReadbacks = 0;
@@ -139,6 +140,8 @@ struct GPUStatistics {
 	int numTexturesHashed;
 	int numTextureDataBytesHashed;
 	int numTexturesDecoded;
+	// 64-bit, since headless benchmarks add this up over a whole run.
+	int64_t numTextureDataBytesDecoded;
 	int numFramebufferEvaluations;
 	int numFBOsCreated;
 	int numBlockingReadbacks;
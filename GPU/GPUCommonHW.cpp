@@ -562,6 +562,7 @@ void GPUCommonHW::DoState(PointerWrap &p) {
 
 void GPUCommonHW::ClearCacheNextFrame() {
 	textureCache_->ClearNextFrame();
+	drawEngineCommon_->ClearVertexCache();
 }
 
 // Needs to be called on GPU thread, not reporting thread.
@@ -779,6 +780,7 @@ void GPUCommonHW::InvalidateCache(u32 addr, int size, GPUInvalidationType type)
 		textureCache_->Invalidate(addr, size, type);
 	else
 		textureCache_->InvalidateAll(type);
+	drawEngineCommon_->InvalidateVertexCache(addr, size, type);
 
 	if (type != GPU_INVALIDATE_ALL && framebufferManager_->MayIntersectFramebufferColor(addr)) {
 		// Vempire invalidates (with writeback) after drawing, but before blitting.
@@ -480,6 +480,7 @@ void BinManager::Drain(bool flushing) {
 		}
 
 		taskRanges_.clear();
+		int gridCols = 1, gridRows = 1;
 		if (h2 >= 18 && w2 >= h2 * 4) {
 			int bin_w = std::max(4, (w2 + maxTasks_ - 1) / maxTasks_) * SCREEN_SCALE_FACTOR * 2;
 			taskRanges_.push_back(BinCoords{ tl.x, tl.y, queueRange_.x1 + bin_w - 1, br.y - 1 });
@@ -487,6 +488,17 @@ void BinManager::Drain(bool flushing) {
 				int x2 = x + bin_w > queueRange_.x2 ? br.x : x + bin_w;
 				taskRanges_.push_back(BinCoords{ x, tl.y, x2 - 1, br.y - 1 });
 			}
+		} else if (h2 >= 18 && w2 >= 18 && (h2 + maxTasks_ - 1) / maxTasks_ < MIN_STRIP_SIZE && ChooseBinGrid(w2, h2, &gridCols, &gridRows)) {
+			// With many threads, strips get too thin and most prims land in several bins.
+			// Use a grid of squarer tiles instead.
+			int bin_w = ((w2 + gridCols - 1) / gridCols) * SCREEN_SCALE_FACTOR * 2;
+			int bin_h = ((h2 + gridRows - 1) / gridRows) * SCREEN_SCALE_FACTOR * 2;
+			SplitBinEdges(binEdgesX_, tl.x, br.x, queueRange_.x1, queueRange_.x2, bin_w);
+			SplitBinEdges(binEdgesY_, tl.y, br.y, queueRange_.y1, queueRange_.y2, bin_h);
+			for (size_t y = 0; y + 1 < binEdgesY_.size(); ++y) {
+				for (size_t x = 0; x + 1 < binEdgesX_.size(); ++x)
+					taskRanges_.push_back(BinCoords{ binEdgesX_[x], binEdgesY_[y], binEdgesX_[x + 1] - 1, binEdgesY_[y + 1] - 1 });
+			}
 		} else if (h2 >= 18 && w2 >= 18) {
 			int bin_h = std::max(4, (h2 + maxTasks_ - 1) / maxTasks_) * SCREEN_SCALE_FACTOR * 2;
 			taskRanges_.push_back(BinCoords{ tl.x, tl.y, br.x - 1, queueRange_.y1 + bin_h - 1 });
@@ -557,6 +569,39 @@ void BinManager::Drain(bool flushing) {
 	}
 }
 
+bool BinManager::ChooseBinGrid(int w2, int h2, int *cols, int *rows) const {
+	int bestCount = 0;
+	int bestSkew = 0;
+	for (int r = 1; r <= maxTasks_; ++r) {
+		int c = maxTasks_ / r;
+		int bin_w = (w2 + c - 1) / c;
+		int bin_h = (h2 + r - 1) / r;
+		if (bin_w < MIN_TILE_SIZE || bin_h < MIN_TILE_SIZE)
+			continue;
+
+		// Prefer more bins, then the squarest tiles (less prim duplication across bins.)
+		int count = c * r;
+		int skew = abs(bin_w - bin_h);
+		if (count > bestCount || (count == bestCount && skew < bestSkew)) {
+			bestCount = count;
+			bestSkew = skew;
+			*cols = c;
+			*rows = r;
+		}
+	}
+
+	// Not worth it unless we actually get more bins than strips would.
+	return bestCount > 1 && *rows > 1 && *cols > 1;
+}
+
+void BinManager::SplitBinEdges(std::vector<int> &edges, int lo, int hi, int start, int end, int binSize) {
+	edges.clear();
+	edges.push_back(lo);
+	for (int v = start + binSize; v <= end; v += binSize)
+		edges.push_back(v);
+	edges.push_back(hi);
+}
+
 void BinManager::Flush(const char *reason) {
 	if (queueRange_.x1 == 0x7FFFFFFF)
 		return;
@@ -230,6 +230,10 @@ class BinManager {
 #else
 	static constexpr int MAX_POSSIBLE_TASKS = 64;
 #endif
+	// Strips thinner than this (in 2 pixel units) get split into a grid of tiles instead.
+	static constexpr int MIN_STRIP_SIZE = 8;
+	// Minimum tile width/height in the grid, in 2 pixel units.
+	static constexpr int MIN_TILE_SIZE = 16;
 	// This is about 1MB of state data.
 	static constexpr int QUEUED_STATES = 4096;
 	// These are 1KB each, so half an MB.
@@ -254,6 +258,8 @@ class BinManager {
 	int maxTasks_ = 1;
 	bool tasksSplit_ = false;
 	std::vector<BinCoords> taskRanges_;
+	std::vector<int> binEdgesX_;
+	std::vector<int> binEdgesY_;
 	BinItemQueue taskQueues_[MAX_POSSIBLE_TASKS];
 	BinTaskList taskLists_[MAX_POSSIBLE_TASKS];
 	std::atomic<bool> taskStatus_[MAX_POSSIBLE_TASKS];
@@ -284,6 +290,8 @@ class BinManager {
 	BinCoords Range(const VertexData &v0, const VertexData &v1);
 	BinCoords Range(const VertexData &v0);
 	void Expand(const BinCoords &range);
+	bool ChooseBinGrid(int w2, int h2, int *cols, int *rows) const;
+	static void SplitBinEdges(std::vector<int> &edges, int lo, int hi, int start, int end, int binSize);
 
 	friend class DrawBinItemsTask;
 };
@@ -19,6 +19,7 @@
 #include <mutex>
 #include "Common/Common.h"
 #include "Common/Data/Convert/ColorConv.h"
+#include "Common/Math/SIMDHeaders.h"
 #include "Core/Config.h"
 #include "GPU/Software/BinManager.h"
 #include "GPU/Software/DrawPixel.h"
@@ -46,6 +47,14 @@ void Shutdown() {
 	jitCache = nullptr;
 }
 
+void GetJitIDs(std::vector<PixelFuncID> &ids) {
+	jitCache->GetIDs(ids);
+}
+
+void PrecompileJit(const std::vector<PixelFuncID> &ids) {
+	jitCache->Precompile(ids);
+}
+
 bool DescribeCodePtr(const u8 *ptr, std::string &name) {
 	if (!jitCache->IsInSpace(ptr)) {
 		return false;
@@ -800,6 +809,90 @@ SingleFunc PixelJitCache::GenericSingle(const PixelFuncID &id) {
 	return nullptr;
 }
 
+#if defined(_M_SSE)
+// Same as StandardAlphaBlend() in RasterizerRectangle, but for the two pixels in the low half.
+static inline __m128i StandardAlphaBlend2(__m128i source, __m128i dst) {
+	const __m128i z = _mm_setzero_si128();
+	const __m128i sourcevec = _mm_unpacklo_epi8(source, z);
+	const __m128i dstvec = _mm_unpacklo_epi8(dst, z);
+
+	// Alpha ends up blended too, but the caller keeps dest alpha anyway.
+	const __m128i srcfactor = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sourcevec, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	const __m128i dstfactor = _mm_sub_epi16(_mm_set1_epi16(255), srcfactor);
+
+	const __m128i half = _mm_set1_epi16(1 << 3);
+	const __m128i s = _mm_mulhi_epi16(_mm_add_epi16(_mm_slli_epi16(sourcevec, 4), half), _mm_add_epi16(_mm_slli_epi16(srcfactor, 4), half));
+	const __m128i d = _mm_mulhi_epi16(_mm_add_epi16(_mm_slli_epi16(dstvec, 4), half), _mm_add_epi16(_mm_slli_epi16(dstfactor, 4), half));
+	return _mm_adds_epi16(s, d);
+}
+
+// Only called when the right column (x + 1) is drawn in both rows, since rows are written as a pair.
+template <bool alphaBlend>
+static void SOFTRAST_CALL DrawQuad8888(int x, int y, const Vec4<int> &z, const Vec4<int> &mask, const Vec4<int> *colors, const PixelFuncID &pixelID) {
+	const int stride = pixelID.cached.framebufStride;
+	const bool row0 = mask[0] >= 0 || mask[1] >= 0;
+	const bool row1 = mask[2] >= 0 || mask[3] >= 0;
+
+	if (pixelID.depthWrite) {
+		for (int i = 0; i < 4; ++i) {
+			if (mask[i] >= 0)
+				SetPixelDepth(x + (i & 1), y + (i / 2), pixelID.cached.depthbufStride, z[i]);
+		}
+	}
+
+	// Packing also clamps to 0-255, like the Clamp() in DrawSinglePixel.
+	const __m128i source = _mm_packus_epi16(_mm_packs_epi32(colors[0].ivec, colors[1].ivec), _mm_packs_epi32(colors[2].ivec, colors[3].ivec));
+	const __m128i dst0 = row0 ? _mm_loadl_epi64((const __m128i *)fb.Get32Ptr(x, y, stride)) : _mm_setzero_si128();
+	const __m128i dst1 = row1 ? _mm_loadl_epi64((const __m128i *)fb.Get32Ptr(x, y + 1, stride)) : _mm_setzero_si128();
+	const __m128i dst = _mm_unpacklo_epi64(dst0, dst1);
+
+	__m128i result = source;
+	if (alphaBlend) {
+		const __m128i blended16lo = StandardAlphaBlend2(source, dst);
+		const __m128i blended16hi = StandardAlphaBlend2(_mm_unpackhi_epi64(source, source), _mm_unpackhi_epi64(dst, dst));
+		const __m128i blended = _mm_packus_epi16(blended16lo, blended16hi);
+		// Like DrawSinglePixel32(), full alpha always skips blending.
+		const __m128i opaque = _mm_cmpeq_epi32(_mm_srai_epi32(source, 24), _mm_set1_epi32(-1));
+		result = _mm_or_si128(_mm_and_si128(opaque, source), _mm_andnot_si128(opaque, blended));
+	}
+
+	// Without a stencil test, stencil (alpha) is kept from the dest.
+	const __m128i alphaMask = _mm_set1_epi32(0xFF000000);
+	result = _mm_or_si128(_mm_andnot_si128(alphaMask, result), _mm_and_si128(alphaMask, dst));
+	// And finally, keep dest for any masked off pixels (any negative mask value.)
+	const __m128i skip = _mm_srai_epi32(mask.ivec, 31);
+	result = _mm_or_si128(_mm_and_si128(skip, dst), _mm_andnot_si128(skip, result));
+
+	if (row0)
+		_mm_storel_epi64((__m128i *)fb.Get32Ptr(x, y, stride), result);
+	if (row1)
+		_mm_storel_epi64((__m128i *)fb.Get32Ptr(x, y + 1, stride), _mm_unpackhi_epi64(result, result));
+}
+#endif
+
+QuadFunc GetQuadFunc(const PixelFuncID &id) {
+#if defined(_M_SSE)
+	if (id.clearMode || id.colorTest || id.stencilTest || id.applyFog)
+		return nullptr;
+	if (id.dithering || id.applyLogicOp || id.applyColorWriteMask)
+		return nullptr;
+	if (id.AlphaTestFunc() != GE_COMP_ALWAYS)
+		return nullptr;
+	// Depth testing (and depth range) must already have happened in the rasterizer.
+	if (!id.earlyZChecks && (id.DepthTestFunc() != GE_COMP_ALWAYS || id.applyDepthRange))
+		return nullptr;
+	if (id.FBFormat() != GE_FORMAT_8888)
+		return nullptr;
+
+	if (!id.alphaBlend)
+		return &DrawQuad8888<false>;
+	// Only standard src.a / 1 - src.a blending, which lets us skip blending when alpha = FF.
+	if (id.AlphaBlendEq() == GE_BLENDMODE_MUL_AND_ADD && id.AlphaBlendSrc() == PixelBlendFactor::SRCALPHA && id.AlphaBlendDst() == PixelBlendFactor::INVSRCALPHA)
+		return &DrawQuad8888<true>;
+#endif
+	return nullptr;
+}
+
 thread_local PixelJitCache::LastCache PixelJitCache::lastSingle_;
 int PixelJitCache::clearGen_ = 0;
 
@@ -849,6 +942,27 @@ void PixelJitCache::Flush() {
 	compileQueue_.clear();
 }
 
+void PixelJitCache::GetIDs(std::vector<PixelFuncID> &ids) {
+	std::unique_lock<std::mutex> guard(jitCacheLock);
+	ids.reserve(ids.size() + addresses_.size() + compileQueue_.size());
+	for (const auto &it : addresses_)
+		ids.push_back(it.first);
+	for (const auto &queued : compileQueue_)
+		ids.push_back(queued);
+}
+
+void PixelJitCache::Precompile(const std::vector<PixelFuncID> &ids) {
+	for (const auto &id : ids) {
+		// Lock per func so the GPU thread doesn't wait on the whole list.
+		std::unique_lock<std::mutex> guard(jitCacheLock);
+		// Compile() clears when low on space, which isn't safe while draws may be running.
+		if (GetSpaceLeft() < 65536 * 2)
+			break;
+		if (!cache_.ContainsKey(std::hash<PixelFuncID>()(id)))
+			Compile(id);
+	}
+}
+
 SingleFunc PixelJitCache::GetSingle(const PixelFuncID &id, BinManager *binner) {
 	if (!g_Config.bSoftwareRenderingJit)
 		return nullptr;
@@ -42,10 +42,19 @@ namespace Rasterizer {
 typedef void (SOFTRAST_CALL *SingleFunc)(int x, int y, int z, int fog, Vec4IntArg color_in, const PixelFuncID &pixelID);
 SingleFunc GetSingleFunc(const PixelFuncID &id, BinManager *binner);
 
+// Draws a 2x2 quad at once (lanes are x + (i & 1), y + (i / 2)), skipping lanes with a negative mask.
+// Only available for simple pixel states, returns nullptr otherwise.
+typedef void (SOFTRAST_CALL *QuadFunc)(int x, int y, const Math3D::Vec4<int> &z, const Math3D::Vec4<int> &mask, const Math3D::Vec4<int> *colors, const PixelFuncID &pixelID);
+QuadFunc GetQuadFunc(const PixelFuncID &id);
+
 void Init();
 void FlushJit();
 void Shutdown();
 
+// For persisting which funcs a game uses, so they can be compiled ahead of time.
+void GetJitIDs(std::vector<PixelFuncID> &ids);
+void PrecompileJit(const std::vector<PixelFuncID> &ids);
+
 bool CheckDepthTestPassed(GEComparison func, int x, int y, int stride, u16 z);
 
 bool DescribeCodePtr(const u8 *ptr, std::string &name);
@@ -69,6 +78,8 @@ class PixelJitCache : public Rasterizer::CodeBlock {
 	static SingleFunc GenericSingle(const PixelFuncID &id);
 	void Clear() override;
 	void Flush();
+	void GetIDs(std::vector<PixelFuncID> &ids);
+	void Precompile(const std::vector<PixelFuncID> &ids);
 
 	std::string DescribeCodePtr(const u8 *ptr) override;
 
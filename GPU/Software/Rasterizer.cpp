@@ -112,6 +112,7 @@ static inline Vec4<float> Interpolate(const float &c0, const float &c1, const fl
 void ComputeRasterizerState(RasterizerState *state, BinManager *binner) {
 	ComputePixelFuncID(&state->pixelID);
 	state->drawPixel = Rasterizer::GetSingleFunc(state->pixelID, binner);
+	state->drawQuad = Rasterizer::GetQuadFunc(state->pixelID);
 
 	state->enableTextures = gstate.isTextureMapEnabled() && !state->pixelID.clearMode;
 	if (state->enableTextures) {
@@ -435,6 +436,7 @@ static bool ApplyStateOptimizations(RasterizerState *state, const RasterizerStat
 		// Can't compile during runtime.  This failing is a bit of a problem when undoing...
 		if (drawPixel) {
 			state->drawPixel = drawPixel;
+			state->drawQuad = Rasterizer::GetQuadFunc(pixelID);
 			memcpy(&state->pixelID, &pixelID, sizeof(PixelFuncID));
 			state->flags = ReplacePixelIDFlags(state->flags, optimize) | RasterizerStateFlags::OPTIMIZED;
 			changed = true;
@@ -1167,6 +1169,15 @@ void DrawTriangleSlice(
 				}
 
 				PROFILE_THIS_SCOPE("draw_tri_px");
+#if !defined(SOFTGPU_MEMORY_TAGGING_DETAILED)
+				// The quad func writes both pixels of a row back, so the right column must be ours to write.
+				// Otherwise it could be past the edge of the bin, where another thread may be drawing.
+				if (state.drawQuad && mask[1] >= 0 && mask[3] >= 0) {
+					state.drawQuad(p.x, p.y, z, mask, prim_color, pixelID);
+					continue;
+				}
+#endif
+
 				DrawingCoords subp = p;
 				for (int i = 0; i < 4; ++i) {
 					if (mask[i] < 0) {
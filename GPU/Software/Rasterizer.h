@@ -69,6 +69,7 @@ struct RasterizerState {
 	PixelFuncID pixelID;
 	SamplerID samplerID;
 	SingleFunc drawPixel;
+	QuadFunc drawQuad;
 	Sampler::LinearFunc linear;
 	Sampler::NearestFunc nearest;
 	uint32_t texaddr[8]{};
@@ -54,6 +54,14 @@ void Shutdown() {
 	jitCache = nullptr;
 }
 
+void GetJitIDs(std::vector<SamplerID> &ids) {
+	jitCache->GetIDs(ids);
+}
+
+void PrecompileJit(const std::vector<SamplerID> &ids) {
+	jitCache->Precompile(ids);
+}
+
 bool DescribeCodePtr(const u8 *ptr, std::string &name) {
 	if (!jitCache->IsInSpace(ptr)) {
 		return false;
@@ -159,6 +167,30 @@ void SamplerJitCache::Flush() {
 	compileQueue_.clear();
 }
 
+void SamplerJitCache::GetIDs(std::vector<SamplerID> &ids) {
+	std::unique_lock<std::mutex> guard(jitCacheLock);
+	ids.reserve(ids.size() + addresses_.size() + compileQueue_.size());
+	for (const auto &it : addresses_) {
+		// Compile() always does fetch, nearest, and linear together, so just keep one.
+		if (!it.first.fetch && !it.first.linear)
+			ids.push_back(it.first);
+	}
+	for (const auto &queued : compileQueue_)
+		ids.push_back(queued);
+}
+
+void SamplerJitCache::Precompile(const std::vector<SamplerID> &ids) {
+	for (const auto &id : ids) {
+		// Lock per func so the GPU thread doesn't wait on the whole list.
+		std::unique_lock<std::mutex> guard(jitCacheLock);
+		// Compile() clears when low on space, which isn't safe while draws may be running.
+		if (GetSpaceLeft() < 16384 * 2)
+			break;
+		if (!cache_.ContainsKey(std::hash<SamplerID>()(id)))
+			Compile(id);
+	}
+}
+
 NearestFunc SamplerJitCache::GetByID(const SamplerID &id, size_t key, BinManager *binner) {
 	std::unique_lock<std::mutex> guard(jitCacheLock);
 	
@@ -21,6 +21,7 @@
 
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 #include "Common/Data/Collections/Hashmaps.h"
 #include "GPU/Math3D.h"
 #include "GPU/Software/FuncId.h"
@@ -50,6 +51,10 @@ void Init();
 void FlushJit();
 void Shutdown();
 
+// For persisting which funcs a game uses, so they can be compiled ahead of time.
+void GetJitIDs(std::vector<SamplerID> &ids);
+void PrecompileJit(const std::vector<SamplerID> &ids);
+
 bool DescribeCodePtr(const u8 *ptr, std::string &name);
 
 class SamplerJitCache : public Rasterizer::CodeBlock {
@@ -62,6 +67,8 @@ class SamplerJitCache : public Rasterizer::CodeBlock {
 	FetchFunc GetFetch(const SamplerID &id, BinManager *binner);
 	void Clear() override;
 	void Flush();
+	void GetIDs(std::vector<SamplerID> &ids);
+	void Precompile(const std::vector<SamplerID> &ids);
 
 	std::string DescribeCodePtr(const u8 *ptr) override;
 
@@ -18,7 +18,11 @@
 #include <set>
 
 #include "Common/System/Display.h"
+#include "Common/File/FileUtil.h"
 #include "Common/GPU/OpenGL/GLFeatures.h"
+#include "Common/Thread/Promise.h"
+#include "Common/Thread/ThreadManager.h"
+#include "Common/Thread/Waitable.h"
 
 #include "GPU/GPUState.h"
 #include "GPU/ge_constants.h"
@@ -31,6 +35,7 @@
 #include "Core/Core.h"
 #include "Core/System.h"
 #include "Core/Debugger/MemBlockInfo.h"
+#include "Core/ELF/ParamSFO.h"
 #include "Core/MemMap.h"
 #include "Core/MIPS/MIPS.h"
 #include "Core/Util/PPGeDraw.h"
@@ -452,6 +457,107 @@ SoftGPU::SoftGPU(GraphicsContext *gfxCtx, Draw::DrawContext *draw)
 	NotifyConfigChanged();
 	NotifyDisplayResized();
 	NotifyRenderResized();
+
+	// Load the list of jit funcs this game used before.
+	std::string discID = g_paramSFO.GetDiscID();
+	if (discID.size()) {
+		File::CreateFullPath(GetSysDirectory(DIRECTORY_APP_CACHE));
+		jitCachePath_ = GetSysDirectory(DIRECTORY_APP_CACHE) / (discID + ".softjitcache");
+		LoadJitCache(jitCachePath_);
+	}
+}
+
+// Just the IDs, the funcs themselves are quick to compile, it's the stall mid-frame that hurts.
+struct SoftJitCacheHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t numPixelIDs;
+	uint32_t numSamplerIDs;
+};
+
+static const uint32_t SOFT_JIT_CACHE_MAGIC = 0x534A4954;  // SJIT
+// Bump this when PixelFuncID or SamplerID bits change meaning.
+static const uint32_t SOFT_JIT_CACHE_VERSION = 1;
+
+void SoftGPU::LoadJitCache(const Path &filename) {
+	if (!g_Config.bShaderCache || !g_Config.bSoftwareRenderingJit)
+		return;
+
+	FILE *f = File::OpenCFile(filename, "rb");
+	if (!f)
+		return;
+
+	SoftJitCacheHeader header{};
+	bool result = fread(&header, sizeof(header), 1, f) == 1;
+	result = result && header.magic == SOFT_JIT_CACHE_MAGIC && header.version == SOFT_JIT_CACHE_VERSION;
+	// Sanity check, there shouldn't be anywhere near this many.
+	result = result && header.numPixelIDs < 0x10000 && header.numSamplerIDs < 0x10000;
+
+	std::vector<uint64_t> pixelKeys;
+	std::vector<uint32_t> samplerKeys;
+	if (result) {
+		pixelKeys.resize(header.numPixelIDs);
+		samplerKeys.resize(header.numSamplerIDs);
+		result = fread(pixelKeys.data(), sizeof(uint64_t), pixelKeys.size(), f) == pixelKeys.size();
+		result = result && fread(samplerKeys.data(), sizeof(uint32_t), samplerKeys.size(), f) == samplerKeys.size();
+	}
+	fclose(f);
+
+	if (!result) {
+		WARN_LOG(Log::G3D, "Incompatible software renderer jit cache - rebuilding.");
+		File::Delete(filename);
+		return;
+	}
+
+	// The cached values aren't part of the key, and aren't used when compiling.
+	std::vector<PixelFuncID> pixelIDs(pixelKeys.size());
+	for (size_t i = 0; i < pixelKeys.size(); ++i)
+		pixelIDs[i].fullKey = pixelKeys[i];
+	std::vector<SamplerID> samplerIDs(samplerKeys.size());
+	for (size_t i = 0; i < samplerKeys.size(); ++i)
+		samplerIDs[i].fullKey = samplerKeys[i];
+
+	INFO_LOG(Log::G3D, "Precompiling %d pixel and %d sampler funcs from software renderer jit cache", (int)pixelIDs.size(), (int)samplerIDs.size());
+	if (PlatformIsWXExclusive()) {
+		// Can't safely write code while other code in the block might be running, so just do it now.
+		Rasterizer::PrecompileJit(pixelIDs);
+		Sampler::PrecompileJit(samplerIDs);
+		return;
+	}
+
+	jitPrecompileWaitable_ = new LimitedWaitable();
+	g_threadManager.EnqueueTask(new IndependentTask(TaskType::CPU_COMPUTE, TaskPriority::LOW,
+		[pixelIDs = std::move(pixelIDs), samplerIDs = std::move(samplerIDs), waitable = jitPrecompileWaitable_]() {
+		Rasterizer::PrecompileJit(pixelIDs);
+		Sampler::PrecompileJit(samplerIDs);
+		waitable->Notify();
+	}));
+}
+
+void SoftGPU::SaveJitCache(const Path &filename) {
+	if (!g_Config.bShaderCache || !g_Config.bSoftwareRenderingJit)
+		return;
+
+	std::vector<PixelFuncID> pixelIDs;
+	std::vector<SamplerID> samplerIDs;
+	Rasterizer::GetJitIDs(pixelIDs);
+	Sampler::GetJitIDs(samplerIDs);
+	if (pixelIDs.empty() && samplerIDs.empty())
+		return;
+
+	FILE *f = File::OpenCFile(filename, "wb");
+	if (!f)
+		return;
+
+	SoftJitCacheHeader header{ SOFT_JIT_CACHE_MAGIC, SOFT_JIT_CACHE_VERSION, (uint32_t)pixelIDs.size(), (uint32_t)samplerIDs.size() };
+	fwrite(&header, sizeof(header), 1, f);
+	for (const PixelFuncID &id : pixelIDs)
+		fwrite(&id.fullKey, sizeof(id.fullKey), 1, f);
+	for (const SamplerID &id : samplerIDs)
+		fwrite(&id.fullKey, sizeof(id.fullKey), 1, f);
+	fclose(f);
+
+	INFO_LOG(Log::G3D, "Saved software renderer jit cache (%d pixel, %d sampler funcs)", (int)pixelIDs.size(), (int)samplerIDs.size());
 }
 
 void SoftGPU::DeviceLost() {
@@ -480,6 +586,14 @@ SoftGPU::~SoftGPU() {
 	delete presentation_;
 	delete drawEngine_;
 
+	if (jitPrecompileWaitable_) {
+		jitPrecompileWaitable_->Wait();
+		delete jitPrecompileWaitable_;
+		jitPrecompileWaitable_ = nullptr;
+	}
+	if (jitCachePath_.Valid())
+		SaveJitCache(jitCachePath_);
+
 	Sampler::Shutdown();
 	Rasterizer::Shutdown();
 }
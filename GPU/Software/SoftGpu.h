@@ -18,10 +18,13 @@
 #pragma once
 
 #include <cstdint>
+#include "Common/File/Path.h"
 #include "GPU/GPUCommon.h"
 #include "GPU/Common/GPUDebugInterface.h"
 #include "Common/GPU/thin3d.h"
 
+class LimitedWaitable;
+
 struct FormatBuffer {
 	FormatBuffer() { data = nullptr; }
 	union {
@@ -225,6 +228,9 @@ class SoftGPU : public GPUCommon {
 	bool ClearDirty(uint32_t addr, uint32_t stride, uint32_t height, GEBufferFormat fmt, SoftGPUVRAMDirty value);
 	bool ClearDirty(uint32_t addr, uint32_t bytes, SoftGPUVRAMDirty value);
 
+	void LoadJitCache(const Path &filename);
+	void SaveJitCache(const Path &filename);
+
 	uint8_t vramDirty_[2048];
 	uint32_t lastDirtyAddr_ = 0;
 	uint32_t lastDirtySize_ = 0;
@@ -240,6 +246,9 @@ class SoftGPU : public GPUCommon {
 
 	Draw::Texture *fbTex = nullptr;
 	std::vector<u32> fbTexBuffer_;
+
+	Path jitCachePath_;
+	LimitedWaitable *jitPrecompileWaitable_ = nullptr;
 };
 
 // TODO: These shouldn't be global.
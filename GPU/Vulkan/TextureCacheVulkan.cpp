@@ -35,6 +35,7 @@
 #include "Common/GPU/Vulkan/VulkanMemory.h"
 
 #include "Core/Config.h"
+#include "Core/MemMap.h"
 
 #include "GPU/ge_constants.h"
 #include "GPU/GPUState.h"
@@ -104,6 +105,62 @@ void main() {
 
 )";
 
+// Looks up CLUT4/CLUT8 indices directly from the PSP texture bytes, unswizzling on the fly,
+// so the CPU only has to copy the raw data and the (expanded) CLUT.
+const char *decodeClutShader = R"(
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout (local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+uniform layout(set = 0, binding = 0, rgba8) writeonly image2D img;
+
+layout(std430, set = 0, binding = 1) readonly buffer Tex {
+	uint data[];
+} tex;
+
+layout(std430, set = 0, binding = 2) readonly buffer Clut {
+	uint data[];
+} clut;
+
+layout(push_constant) uniform Params {
+	uint size;       // width | (height << 16)
+	uint bufw;       // in texels
+	uint flags;      // 1 = CLUT4, 2 = swizzled
+	uint clutIndex;  // shift | (mask << 8) | (start pos << 16)
+} params;
+
+uint readByte(uint offset) {
+	return (tex.data[offset >> 2] >> ((offset & 3) * 8)) & 0xFF;
+}
+
+void main() {
+	uvec2 xy = gl_GlobalInvocationID.xy;
+	if (xy.x >= (params.size & 0xFFFF) || xy.y >= (params.size >> 16))
+		return;
+
+	bool clut4 = (params.flags & 1) != 0;
+	uint bx = clut4 ? (xy.x >> 1) : xy.x;
+	uint rowBytes = clut4 ? (params.bufw >> 1) : params.bufw;
+	uint offset;
+	if ((params.flags & 2) != 0) {
+		// Swizzled data is stored as 16 byte x 8 row blocks, see UnswizzleFromMem.
+		uint block = (xy.y >> 3) * (rowBytes >> 4) + (bx >> 4);
+		offset = block * 128 + (xy.y & 7) * 16 + (bx & 15);
+	} else {
+		offset = xy.y * rowBytes + bx;
+	}
+
+	uint index = readByte(offset);
+	if (clut4)
+		index = (index >> ((xy.x & 1) * 4)) & 0xF;
+	// Same as GPUgstate::transformClutIndex, the start pos is pre-masked.
+	index = ((index >> (params.clutIndex & 0x1F)) & ((params.clutIndex >> 8) & 0xFF)) | (params.clutIndex >> 16);
+	imageStore(img, ivec2(xy), unpackUnorm4x8(clut.data[index]));
+}
+
+)";
+
 static int VkFormatBytesPerPixel(VkFormat format) {
 	switch (format) {
 	case VULKAN_8888_FORMAT: return 4;
@@ -221,6 +278,8 @@ void TextureCacheVulkan::DeviceLost() {
 
 	if (uploadCS_ != VK_NULL_HANDLE)
 		vulkan->Delete().QueueDeleteShaderModule(uploadCS_);
+	if (decodeClutCS_ != VK_NULL_HANDLE)
+		vulkan->Delete().QueueDeleteShaderModule(decodeClutCS_);
 
 	computeShaderManager_.DeviceLost();
 
@@ -250,6 +309,12 @@ void TextureCacheVulkan::DeviceRestore(Draw::DrawContext *draw) {
 
 	CompileScalingShader();
 
+	std::string error;
+	decodeClutCS_ = CompileShaderModule(vulkan, VK_SHADER_STAGE_COMPUTE_BIT, decodeClutShader, &error);
+	if (decodeClutCS_ == VK_NULL_HANDLE) {
+		WARN_LOG(Log::G3D, "Failed to compile CLUT decode shader, decoding on the CPU: %s", error.c_str());
+	}
+
 	computeShaderManager_.DeviceRestore(draw);
 }
 
@@ -420,6 +485,34 @@ static VkFormat ToVulkanFormat(Draw::DataFormat fmt) {
 	}
 }
 
+bool TextureCacheVulkan::CanDecodeClutWithCompute(const TexCacheEntry *entry, const BuildTexturePlan &plan, VkFormat actualFmt) const {
+	if (decodeClutCS_ == VK_NULL_HANDLE || actualFmt != VULKAN_8888_FORMAT)
+		return false;
+	if (entry->format != GE_TFMT_CLUT4 && entry->format != GE_TFMT_CLUT8)
+		return false;
+	// Scaling, replacement, saving and CLUT8 output all want the CPU decoded pixels.
+	if (plan.scaleFactor > 1 || plan.doReplace || plan.saveTexture || plan.decodeToClut8 || plan.depth != 1)
+		return false;
+
+	const GETextureFormat tfmt = (GETextureFormat)entry->format;
+	const bool swizzled = gstate.isTextureSwizzled();
+	for (int i = 0; i < plan.levelsToLoad; i++) {
+		const int level = i == 0 ? plan.baseLevelSrc : i;
+		const u32 texaddr = gstate.getTextureAddress(level);
+		const int w = gstate.getTextureWidth(level);
+		const int h = gstate.getTextureHeight(level);
+		const int bufw = GetTextureBufw(level, texaddr, tfmt);
+		// The CPU path reads past the row here, don't try to match that.
+		if (w > bufw)
+			return false;
+		const u32 rowBytes = tfmt == GE_TFMT_CLUT4 ? bufw / 2 : bufw;
+		const u32 size = rowBytes * (swizzled ? ((h + 7) & ~7) : h);
+		if (!Memory::IsValidRange(texaddr, size))
+			return false;
+	}
+	return true;
+}
+
 void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 	VulkanContext *vulkan = (VulkanContext *)draw_->GetNativeObject(Draw::NativeObject::CONTEXT);
 
@@ -487,16 +580,19 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 		}
 	}
 
-	if (computeUpload) {
-		usage |= VK_IMAGE_USAGE_STORAGE_BIT;
-		imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-	}
-
 	if (plan.saveTexture) {
 		INFO_LOG(Log::G3D, "About to save texture (%dx%d)", plan.createW, plan.createH);
 		actualFmt = VULKAN_8888_FORMAT;
 	}
 
+	// Paletted textures can skip the CPU deindex/unswizzle entirely.
+	bool computeDecode = !computeUpload && CanDecodeClutWithCompute(entry, plan, actualFmt);
+
+	if (computeUpload || computeDecode) {
+		usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+		imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+	}
+
 	const VkComponentMapping *mapping;
 	switch (actualFmt) {
 	case VULKAN_4444_FORMAT: mapping = &VULKAN_4444_SWIZZLE; break;
@@ -536,6 +632,7 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 		plan.createH /= plan.scaleFactor;
 		plan.scaleFactor = 1;
 		actualFmt = dstFmt;
+		computeDecode = false;
 
 		allocSuccess = image->CreateDirect(plan.createW, plan.createH, plan.depth, plan.levelsToCreate, actualFmt, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, &barrier, mapping);
 		barrier.Flush(cmdInit);
@@ -643,6 +740,56 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 				vkCmdDispatch(cmdInit, (mipUnscaledWidth + 7) / 8, (mipUnscaledHeight + 7) / 8, 1);
 				VK_PROFILE_END(vulkan, cmdInit, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
 				vulkan->Delete().QueueDeleteImageView(view);
+			} else if (computeDecode) {
+				const int srcLevel = i == 0 ? plan.baseLevelSrc : i;
+				const GETextureFormat tfmt = (GETextureFormat)entry->format;
+				const bool clut4 = tfmt == GE_TFMT_CLUT4;
+				const bool swizzled = gstate.isTextureSwizzled();
+				const u32 texaddr = gstate.getTextureAddress(srcLevel);
+				const int bufw = GetTextureBufw(srcLevel, texaddr, tfmt);
+				const u32 rowBytes = clut4 ? bufw / 2 : bufw;
+				const u32 srcSize = rowBytes * (swizzled ? ((mipUnscaledHeight + 7) & ~7) : mipUnscaledHeight);
+
+				// The shader reads whole words, and the buffers are bound as storage.
+				const int storageAlignment = std::max(pushAlignment, (int)vulkan->GetPhysicalDeviceProperties().properties.limits.minStorageBufferOffsetAlignment);
+				const u32 alignedSize = (srcSize + 3) & ~3;
+				uint8_t *texData = (uint8_t *)pushBuffer->Allocate(alignedSize, storageAlignment, &texBuf, &bufferOffset);
+				memcpy(texData, Memory::GetPointerUnchecked(texaddr), srcSize);
+				memset(texData + srcSize, 0, alignedSize - srcSize);
+
+				int clutEntries = 0;
+				const u32 *clut = GetClut8888ForLevel(tfmt, srcLevel, &clutEntries);
+				VkBuffer clutBuf;
+				uint32_t clutOffset;
+				uint8_t *clutData = (uint8_t *)pushBuffer->Allocate(clutEntries * sizeof(u32), storageAlignment, &clutBuf, &clutOffset);
+				memcpy(clutData, clut, clutEntries * sizeof(u32));
+
+				// We don't look at the pixels, so judge alpha by the CLUT entries the indices can reach.
+				const int reachable = gstate.isClutIndexSimple() ? (clut4 ? 16 : 256) : clutEntries;
+				u32 alphaSum = 0xFFFFFFFF;
+				for (int c = 0; c < reachable; c++) {
+					alphaSum &= clut[c];
+				}
+				entry->SetAlphaStatus((alphaSum & 0xFF000000) == 0xFF000000 ? CHECKALPHA_FULL : CHECKALPHA_ANY, i);
+
+				const u32 clutStartMask = clutEntries - 1;
+				struct Params { u32 size; u32 bufw; u32 flags; u32 clutIndex; } params{
+					(u32)mipUnscaledWidth | ((u32)mipUnscaledHeight << 16),
+					(u32)bufw,
+					(clut4 ? 1U : 0U) | (swizzled ? 2U : 0U),
+					(u32)gstate.getClutIndexShift() | ((u32)gstate.getClutIndexMask() << 8) | (((u32)gstate.getClutIndexStartPos() & clutStartMask) << 16),
+				};
+
+				VkImageView view = entry->vkTex->CreateViewForMip(i);
+				VkDescriptorSet descSet = computeShaderManager_.GetDescriptorSet(view, texBuf, bufferOffset, alignedSize, clutBuf, clutOffset, clutEntries * sizeof(u32));
+				VK_PROFILE_BEGIN(vulkan, cmdInit, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+					"Compute CLUT decode: %dx%d", mipUnscaledWidth, mipUnscaledHeight);
+				vkCmdBindPipeline(cmdInit, VK_PIPELINE_BIND_POINT_COMPUTE, computeShaderManager_.GetPipeline(decodeClutCS_));
+				vkCmdBindDescriptorSets(cmdInit, VK_PIPELINE_BIND_POINT_COMPUTE, computeShaderManager_.GetPipelineLayout(), 0, 1, &descSet, 0, nullptr);
+				vkCmdPushConstants(cmdInit, computeShaderManager_.GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
+				vkCmdDispatch(cmdInit, (mipUnscaledWidth + 7) / 8, (mipUnscaledHeight + 7) / 8, 1);
+				VK_PROFILE_END(vulkan, cmdInit, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+				vulkan->Delete().QueueDeleteImageView(view);
 			} else {
 				loadLevel(uploadSize, i == 0 ? plan.baseLevelSrc : i, byteStride, plan.scaleFactor);
 				entry->vkTex->CopyBufferToMipLevel(cmdInit, &copyBatch, i, mipWidth, mipHeight, 0, texBuf, bufferOffset, pixelStride);
@@ -672,14 +819,15 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 		VK_PROFILE_END(vulkan, cmdInit, VK_PIPELINE_STAGE_TRANSFER_BIT);
 	}
 
-	VkImageLayout layout = computeUpload ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-	VkPipelineStageFlags prevStage = computeUpload ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_TRANSFER_BIT;
+	const bool computeWritten = computeUpload || computeDecode;
+	VkImageLayout layout = computeWritten ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	VkPipelineStageFlags prevStage = computeWritten ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_TRANSFER_BIT;
 
 	// Generate any additional mipmap levels.
 	// This will transition the whole stack to GENERAL if it wasn't already.
 	if (plan.levelsToLoad < plan.levelsToCreate) {
 		VK_PROFILE_BEGIN(vulkan, cmdInit, VK_PIPELINE_STAGE_TRANSFER_BIT, "Mipgen up to level %d", plan.levelsToCreate);
-		entry->vkTex->GenerateMips(cmdInit, plan.levelsToLoad, computeUpload);
+		entry->vkTex->GenerateMips(cmdInit, plan.levelsToLoad, computeWritten);
 		layout = VK_IMAGE_LAYOUT_GENERAL;
 		prevStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
 		VK_PROFILE_END(vulkan, cmdInit, VK_PIPELINE_STAGE_TRANSFER_BIT);
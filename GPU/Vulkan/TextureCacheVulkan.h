@@ -101,6 +101,7 @@ class TextureCacheVulkan : public TextureCacheCommon {
 	void BuildTexture(TexCacheEntry *const entry) override;
 
 	void CompileScalingShader();
+	bool CanDecodeClutWithCompute(const TexCacheEntry *entry, const BuildTexturePlan &plan, VkFormat actualFmt) const;
 
 	VulkanDeviceAllocator *allocator_ = nullptr;
 
@@ -112,6 +113,8 @@ class TextureCacheVulkan : public TextureCacheCommon {
 
 	std::string textureShader_;
 	VkShaderModule uploadCS_ = VK_NULL_HANDLE;
+	// Decodes CLUT4/CLUT8 textures, linear or swizzled, straight from the raw PSP bytes.
+	VkShaderModule decodeClutCS_ = VK_NULL_HANDLE;
 
 	// Bound state to emulate an API similar to the others
 	VkImageView imageView_ = VK_NULL_HANDLE;
@@ -157,6 +157,10 @@ void DevMenuScreen::CreatePopupContents(UI::ViewGroup *parent) {
 	if (PSP_CoreParameter().fileType != IdentifiedFileType::PPSSPP_GE_DUMP) {
 		items->Add(new Choice(dev->T("Create frame dump")))->OnClick.Add([](UI::EventParams &e) {
 			gpuDebug->GetRecorder()->RecordNextFrame([](const Path &dumpPath) {
+				if (dumpPath.empty()) {
+					ERROR_LOG(Log::System, "Frame dump failed");
+					return;
+				}
 				NOTICE_LOG(Log::System, "Frame dump created at '%s'", dumpPath.c_str());
 				if (System_GetPropertyBool(SYSPROP_CAN_SHOW_FILE)) {
 					System_ShowFileInFolder(dumpPath);
@@ -73,6 +73,7 @@
 #include "Core/System.h"
 #include "Core/Reporting.h"
 #include "Core/WebServer.h"
+#include "Core/FileLoaders/LocalFileLoader.h"
 #include "Core/HLE/sceUsbCam.h"
 #include "Core/HLE/sceUsbMic.h"
 #include "GPU/Common/TextureReplacer.h"
@@ -528,6 +529,13 @@ void GameSettingsScreen::CreateGraphicsSettings(UI::ViewGroup *graphicsSettings)
 	});
 	swSkin->SetDisabledPtr(&g_Config.bSoftwareRendering);
 
+	CheckBox *vertexCache = graphicsSettings->Add(new CheckBox(&g_Config.bVertexCache, gr->T("Vertex Cache")));
+	vertexCache->OnClick.Add([=](EventParams &e) {
+		settingInfo_->Show(gr->T("VertexCache Tip", "Reuse decoded vertices when the game draws the same model again, faster in some games"), e.v);
+		return UI::EVENT_CONTINUE;
+	});
+	vertexCache->SetDisabledPtr(&g_Config.bSoftwareRendering);
+
 	CheckBox *tessellationHW = graphicsSettings->Add(new CheckBox(&g_Config.bHardwareTessellation, gr->T("Hardware Tessellation")));
 	tessellationHW->OnClick.Add([=](EventParams &e) {
 		settingInfo_->Show(gr->T("HardwareTessellation Tip", "Uses hardware to make curves"), e.v);
@@ -716,6 +724,11 @@ void GameSettingsScreen::CreateAudioSettings(UI::ViewGroup *audioSettings) {
 	}
 #endif
 
+	static const char *resamplers[] = { "Linear", "Sinc (higher quality)" };
+	audioSettings->Add(new PopupMultiChoice(&g_Config.iAudioResampler, a->T("Resampler"), resamplers, 0, ARRAY_SIZE(resamplers), I18NCat::AUDIO, screenManager()));
+	PopupSliderChoice *latencyTarget = audioSettings->Add(new PopupSliderChoice(&g_Config.iAudioLatencyTargetMs, 0, 100, 0, a->T("Audio latency target"), 5, screenManager(), a->T("ms")));
+	latencyTarget->SetZeroLabel(a->T("Auto"));
+
 	bool sdlAudio = false;
 #if defined(SDL)
 	std::vector<std::string> audioDeviceList;
@@ -1344,6 +1357,9 @@ void GameSettingsScreen::CreateSystemSettings(UI::ViewGroup *systemSettings) {
 	if (System_GetPropertyBool(SYSPROP_ENOUGH_RAM_FOR_FULL_ISO)) {
 		systemSettings->Add(new CheckBox(&g_Config.bCacheFullIsoInRam, sy->T("Cache ISO in RAM", "Cache full ISO in RAM")))->SetEnabled(!PSP_IsInited());
 	}
+#ifdef LOCAL_FILE_LOADER_MMAP
+	systemSettings->Add(new CheckBox(&g_Config.bMapIsoFiles, sy->T("Memory map ISO files")))->SetEnabled(!PSP_IsInited());
+#endif
 
 	systemSettings->Add(new CheckBox(&g_Config.bCheckForNewVersion, sy->T("VersionCheck", "Check for new versions of PPSSPP")));
 	systemSettings->Add(new CheckBox(&g_Config.bScreenshotsAsPNG, sy->T("Screenshots as PNG")));
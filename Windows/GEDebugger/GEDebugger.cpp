@@ -1084,7 +1084,8 @@ BOOL CGEDebugger::DlgProc(UINT message, WPARAM wParam, LPARAM lParam) {
 		case IDC_GEDBG_RECORD:
 			gpuDebug->GetRecorder()->RecordNextFrame([](const Path &path) {
 				// Opens a Windows Explorer window with the file, when done.
-				System_ShowFileInFolder(path);
+				if (!path.empty())
+					System_ShowFileInFolder(path);
 			});
 			break;
 
@@ -993,6 +993,9 @@ ifeq ($(UNITTEST),1)
     $(SRC)/unittest/TestShaderGenerators.cpp \
     $(SRC)/unittest/TestSoftwareGPUJit.cpp \
     $(SRC)/unittest/TestThreadManager.cpp \
+    $(SRC)/unittest/TestSerializer.cpp \
+    $(SRC)/unittest/TestThreadQueueList.cpp \
+    $(SRC)/unittest/TestCoreTiming.cpp \
     $(SRC)/unittest/TestVertexJit.cpp \
     $(SRC)/unittest/TestVFS.cpp \
     $(TESTARMEMITTER_FILE) \
@@ -26,6 +26,7 @@
 #include <csignal>
 #endif
 #include "Common/CPUDetect.h"
+#include "Common/Data/Format/JSONWriter.h"
 #include "Common/File/VFS/VFS.h"
 #include "Common/File/VFS/ZipFileReader.h"
 #include "Common/File/VFS/DirectoryReader.h"
@@ -40,8 +41,11 @@
 #include "Core/CoreTiming.h"
 #include "Core/System.h"
 #include "Core/WebServer.h"
+#include "Core/HLE/sceKernel.h"
 #include "Core/HLE/sceUtility.h"
+#include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/SaveState.h"
+#include "GPU/GPU.h"
 #include "GPU/Common/FramebufferManagerCommon.h"
 #include "Common/Log.h"
 #include "Common/Log/LogManager.h"
@@ -149,6 +153,11 @@ int printUsage(const char *progname, const char *reason)
 	fprintf(stderr, "  -j                    use jit (default)\n");
 	fprintf(stderr, "  -c, --compare         compare with output in file.expected\n");
 	fprintf(stderr, "  --bench               run multiple times and output speed\n");
+	fprintf(stderr, "  --bench-cores=LIST    bench each cpu core in LIST, comma separated\n");
+	fprintf(stderr, "                        options: interpreter, ir, jit, jitir\n");
+	fprintf(stderr, "  --bench-json=FILE     also write bench results as JSON to FILE (- for stdout)\n");
+	fprintf(stderr, "  --bench-runs=NUMBER   maximum runs per bench (default 100)\n");
+	fprintf(stderr, "\nA directory runs every .ppdmp frame dump inside it.\n");
 	fprintf(stderr, "\nSee headless.txt for details.\n");
 
 	return 1;
@@ -176,7 +185,65 @@ struct AutoTestOptions {
 	bool bench : 1;
 };
 
-bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, const AutoTestOptions &opt) {
+// Accumulated over bench runs.  Times are in seconds, and only cover emulation (not boot.)
+struct BenchStats {
+	double runs = 0.0;
+	double total = 0.0;
+	double jitCompile = 0.0;
+	double hle = 0.0;
+	double gpu = 0.0;
+	u64 emulatedCycles = 0;
+	int jitCompiles = 0;
+	// GPU work, mainly useful for frame dumps.
+	u64 drawCalls = 0;
+	u64 vertsSubmitted = 0;
+	u64 texturesDecoded = 0;
+	u64 textureBytesDecoded = 0;
+
+	void Add(const BenchStats &other) {
+		runs += other.runs;
+		total += other.total;
+		jitCompile += other.jitCompile;
+		hle += other.hle;
+		gpu += other.gpu;
+		emulatedCycles += other.emulatedCycles;
+		jitCompiles += other.jitCompiles;
+		drawCalls += other.drawCalls;
+		vertsSubmitted += other.vertsSubmitted;
+		texturesDecoded += other.texturesDecoded;
+		textureBytesDecoded += other.textureBytesDecoded;
+	}
+};
+
+static const char *CPUCoreBenchName(CPUCore core) {
+	switch (core) {
+	case CPUCore::INTERPRETER: return "interpreter";
+	case CPUCore::JIT: return "jit";
+	case CPUCore::IR_INTERPRETER: return "ir";
+	case CPUCore::JIT_IR: return "jitir";
+	}
+	return "unknown";
+}
+
+static bool ParseBenchCores(std::string_view list, std::vector<CPUCore> *cores) {
+	std::vector<std::string_view> names;
+	SplitString(list, ',', names);
+	for (std::string_view name : names) {
+		if (name == "interpreter" || name == "i")
+			cores->push_back(CPUCore::INTERPRETER);
+		else if (name == "ir")
+			cores->push_back(CPUCore::IR_INTERPRETER);
+		else if (name == "jit" || name == "j")
+			cores->push_back(CPUCore::JIT);
+		else if (name == "jitir" || name == "jit-ir")
+			cores->push_back(CPUCore::JIT_IR);
+		else
+			return false;
+	}
+	return !cores->empty();
+}
+
+bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, const AutoTestOptions &opt, BenchStats *benchStats = nullptr) {
 	// Kinda ugly, trying to guesstimate the test name from filename...
 	currentTestName = GetTestName(coreParameter.fileToStart);
 
@@ -209,7 +276,8 @@ bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, const
 
 	System_Notify(SystemNotification::BOOT_DONE);
 
-	PSP_UpdateDebugStats((DebugOverlay)g_Config.iDebugOverlay == DebugOverlay::DEBUG_STATS || g_Config.bLogFrameDrops);
+	// The bench breakdown comes from the debug stats, so collect them in bench mode.
+	PSP_UpdateDebugStats((DebugOverlay)g_Config.iDebugOverlay == DebugOverlay::DEBUG_STATS || g_Config.bLogFrameDrops || benchStats != nullptr);
 
 	PSP_BeginHostFrame();
 	Draw::DrawContext *draw = coreParameter.graphicsContext ? coreParameter.graphicsContext->GetDrawContext() : nullptr;
@@ -217,7 +285,8 @@ bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, const
 		draw->BeginFrame(Draw::DebugFlags::NONE);
 
 	bool passed = true;
-	double deadline = time_now_d() + opt.timeout;
+	double startTime = time_now_d();
+	double deadline = startTime + opt.timeout;
 	coreState = coreParameter.startBreak ? CORE_STEPPING_CPU : CORE_RUNNING_CPU;
 	while (coreState == CORE_RUNNING_CPU || coreState == CORE_STEPPING_CPU)
 	{
@@ -251,6 +320,21 @@ bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, const
 			Core_Stop();
 		}
 	}
+
+	if (benchStats) {
+		benchStats->runs += 1.0;
+		benchStats->total += time_now_d() - startTime;
+		benchStats->jitCompile += MIPSComp::jitStats.timeCompiling;
+		benchStats->jitCompiles += MIPSComp::jitStats.numCompiles;
+		benchStats->hle += kernelStats.msInSyscalls;
+		benchStats->gpu += gpuStats.msProcessingDisplayLists;
+		benchStats->emulatedCycles += CoreTiming::GetTicks();
+		// These are only reset at startup in headless, so they cover the whole run.
+		benchStats->drawCalls += gpuStats.numDrawCalls;
+		benchStats->vertsSubmitted += gpuStats.numVertsSubmitted;
+		benchStats->texturesDecoded += gpuStats.numTexturesDecoded;
+		benchStats->textureBytesDecoded += gpuStats.numTextureDataBytesDecoded;
+	}
 	PSP_EndHostFrame();
 
 	if (draw) {
@@ -312,15 +396,26 @@ static void AddRecursively(std::vector<std::string> *tests, Path actualPath) {
 	}
 }
 
+static void AddFrameDumps(std::vector<std::string> *tests, Path actualPath) {
+	std::vector<File::FileInfo> fileInfo;
+	if (!File::GetFilesInDir(actualPath, &fileInfo, "ppdmp")) {
+		return;
+	}
+	for (const auto &file : fileInfo) {
+		if (!file.isDirectory)
+			tests->push_back((actualPath / file.name).ToString());
+	}
+}
+
 static void AddTestsByPath(std::vector<std::string> *tests, std::string_view path) {
 	if (endsWith(path, "/...")) {
 		path = path.substr(0, path.size() - 4);
 		// Recurse for tests
 		AddRecursively(tests, Path(path));
-	} /* else if (File::IsDirectory(Path(path))) {
-		// Alternate syntax - just specify the path.
-		AddRecursively(tests, Path(path));
-	} */ else {
+	} else if (File::IsDirectory(Path(path))) {
+		// Used for benchmarking a set of frame dumps.
+		AddFrameDumps(tests, Path(path));
+	} else {
 		tests->push_back(std::string(path));
 	}
 }
@@ -350,6 +445,9 @@ int main(int argc, const char* argv[])
 	const char *stateToLoad = 0;
 	GPUCore gpuCore = GPUCORE_SOFTWARE;
 	CPUCore cpuCore = CPUCore::JIT;
+	std::vector<CPUCore> benchCores;
+	const char *benchJsonFilename = nullptr;
+	int benchRuns = 100;
 	int debuggerPort = -1;
 	bool oldAtrac = false;
 	bool outputDebugStringLog = false;
@@ -390,6 +488,17 @@ int main(int argc, const char* argv[])
 			testOptions.compare = true;
 		else if (!strcmp(argv[i], "--bench"))
 			testOptions.bench = true;
+		else if (!strncmp(argv[i], "--bench-cores=", strlen("--bench-cores=")) && strlen(argv[i]) > strlen("--bench-cores=")) {
+			testOptions.bench = true;
+			if (!ParseBenchCores(argv[i] + strlen("--bench-cores="), &benchCores))
+				return printUsage(argv[0], "Unknown cpu core specified after --bench-cores=. Allowed: interpreter, ir, jit, jitir.");
+		} else if (!strncmp(argv[i], "--bench-json=", strlen("--bench-json=")) && strlen(argv[i]) > strlen("--bench-json=")) {
+			testOptions.bench = true;
+			benchJsonFilename = argv[i] + strlen("--bench-json=");
+		} else if (!strncmp(argv[i], "--bench-runs=", strlen("--bench-runs=")) && strlen(argv[i]) > strlen("--bench-runs=")) {
+			testOptions.bench = true;
+			benchRuns = std::max(1, (int)strtol(argv[i] + strlen("--bench-runs="), nullptr, 10));
+		}
 		else if (!strcmp(argv[i], "-v") || !strcmp(argv[i], "--verbose"))
 			testOptions.verbose = true;
 		else if (!strcmp(argv[i], "--old-atrac"))
@@ -456,6 +565,8 @@ int main(int argc, const char* argv[])
 
 	if (testFilenames.empty())
 		return printUsage(argv[0], argc <= 1 ? NULL : "No executables specified");
+	if (benchCores.empty())
+		benchCores.push_back(cpuCore);
 
 	g_Config.bEnableLogging = (fullLog || outputDebugStringLog);
 	g_logManager.Init(&g_Config.bEnableLogging, outputDebugStringLog);
@@ -596,6 +707,14 @@ int main(int argc, const char* argv[])
 
 	std::vector<std::string> failedTests;
 	std::vector<std::string> passedTests;
+
+	json::JsonWriter benchJson(json::JsonWriter::PRETTY);
+	if (benchJsonFilename) {
+		benchJson.begin();
+		benchJson.writeString("version", PPSSPP_GIT_VERSION);
+		benchJson.pushArray("results");
+	}
+
 	for (size_t i = 0; i < testFilenames.size(); ++i)
 	{
 		coreParameter.fileToStart = Path(testFilenames[i]);
@@ -603,20 +722,58 @@ int main(int argc, const char* argv[])
 			printf("%s:\n", coreParameter.fileToStart.c_str());
 		bool passed = RunAutoTest(headlessHost, coreParameter, testOptions);
 		if (testOptions.bench) {
-			double st = time_now_d();
-			double deadline = st + testOptions.timeout;
-			double runs = 0.0;
-			for (int i = 0; i < 100; ++i) {
-				RunAutoTest(headlessHost, coreParameter, testOptions);
-				runs++;
-
-				if (time_now_d() > deadline)
-					break;
-			}
-			double et = time_now_d();
-
 			std::string testName = GetTestName(coreParameter.fileToStart);
-			printf("  %s - %f seconds average\n", testName.c_str(), (et - st) / runs);
+			for (CPUCore benchCore : benchCores) {
+				coreParameter.cpuCore = benchCore;
+
+				BenchStats stats;
+				double st = time_now_d();
+				double deadline = st + testOptions.timeout;
+				for (int i = 0; i < benchRuns; ++i) {
+					RunAutoTest(headlessHost, coreParameter, testOptions, &stats);
+
+					if (time_now_d() > deadline)
+						break;
+				}
+				double et = time_now_d();
+
+				// Whatever isn't compiling, in syscalls, or running display lists is (roughly) executing code.
+				double execution = std::max(0.0, stats.total - stats.jitCompile - stats.hle - stats.gpu);
+				double cyclesPerSecond = stats.total > 0.0 ? (double)stats.emulatedCycles / stats.total : 0.0;
+				auto percent = [&](double t) {
+					return stats.total > 0.0 ? 100.0 * t / stats.total : 0.0;
+				};
+				if (benchCores.size() > 1)
+					printf("  %s (%s) - %f seconds average\n", testName.c_str(), CPUCoreBenchName(benchCore), (et - st) / stats.runs);
+				else
+					printf("  %s - %f seconds average\n", testName.c_str(), (et - st) / stats.runs);
+				printf("    %.2f Mcycles/sec, jit %.1f%%, exec %.1f%%, hle %.1f%%, gpu %.1f%%\n", cyclesPerSecond / 1000000.0,
+					percent(stats.jitCompile), percent(execution), percent(stats.hle), percent(stats.gpu));
+				if (stats.drawCalls != 0)
+					printf("    %.0f draws, %.0f verts, %.0f textures decoded (%.1f KB) per run\n", (double)stats.drawCalls / stats.runs,
+						(double)stats.vertsSubmitted / stats.runs, (double)stats.texturesDecoded / stats.runs, (double)stats.textureBytesDecoded / stats.runs / 1024.0);
+
+				if (benchJsonFilename) {
+					benchJson.pushDict();
+					benchJson.writeString("test", testName);
+					benchJson.writeString("core", CPUCoreBenchName(benchCore));
+					benchJson.writeInt("runs", (int)stats.runs);
+					benchJson.writeFloat("secondsAverage", (et - st) / stats.runs);
+					benchJson.writeFloat("emulatedCycles", (double)stats.emulatedCycles / stats.runs);
+					benchJson.writeFloat("cyclesPerSecond", cyclesPerSecond);
+					benchJson.writeFloat("jitCompileSeconds", stats.jitCompile / stats.runs);
+					benchJson.writeFloat("jitCompiles", (double)stats.jitCompiles / stats.runs);
+					benchJson.writeFloat("executionSeconds", execution / stats.runs);
+					benchJson.writeFloat("hleSeconds", stats.hle / stats.runs);
+					benchJson.writeFloat("gpuSeconds", stats.gpu / stats.runs);
+					benchJson.writeFloat("drawCalls", (double)stats.drawCalls / stats.runs);
+					benchJson.writeFloat("vertsSubmitted", (double)stats.vertsSubmitted / stats.runs);
+					benchJson.writeFloat("texturesDecoded", (double)stats.texturesDecoded / stats.runs);
+					benchJson.writeFloat("textureBytesDecoded", (double)stats.textureBytesDecoded / stats.runs);
+					benchJson.pop();
+				}
+			}
+			coreParameter.cpuCore = cpuCore;
 		}
 		if (testOptions.compare) {
 			std::string testName = GetTestName(coreParameter.fileToStart);
@@ -640,6 +797,16 @@ int main(int argc, const char* argv[])
 		}
 	}
 
+	if (benchJsonFilename) {
+		benchJson.pop();
+		benchJson.end();
+		if (!strcmp(benchJsonFilename, "-")) {
+			printf("%s\n", benchJson.str().c_str());
+		} else if (!File::WriteStringToFile(true, benchJson.str(), Path(std::string(benchJsonFilename)))) {
+			fprintf(stderr, "Unable to write bench results to '%s'\n", benchJsonFilename);
+		}
+	}
+
 	if (debuggerPort > 0) {
 		ShutdownWebServer();
 	}
@@ -0,0 +1,171 @@
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "Common/Serialize/Serializer.h"
+#include "Common/Serialize/SerializeFuncs.h"
+#include "Core/CoreTiming.h"
+#include "Core/MIPS/MIPS.h"
+
+#include "UnitTest.h"
+
+static std::vector<std::pair<int, u64>> firedEvents;
+static int eventA = -1;
+static int eventB = -1;
+static int eventC = -1;
+
+static void EventCallbackA(u64 userdata, int cyclesLate) {
+	firedEvents.emplace_back(eventA, userdata);
+}
+
+static void EventCallbackB(u64 userdata, int cyclesLate) {
+	firedEvents.emplace_back(eventB, userdata);
+}
+
+static void EventCallbackC(u64 userdata, int cyclesLate) {
+	firedEvents.emplace_back(eventC, userdata);
+}
+
+static void RunUntil(s64 ticks) {
+	currentMIPS->downcount -= (int)(ticks - (s64)CoreTiming::GetTicks());
+	CoreTiming::Advance();
+}
+
+struct CoreTimingState {
+	void DoState(PointerWrap &p) {
+		CoreTiming::DoState(p);
+	}
+};
+
+// Writes the events the way the old linked list did, to check the format didn't change.
+struct OldLayoutState {
+	std::vector<CoreTiming::BaseEvent> events;
+	int numEventTypes;
+	int slicelength;
+	s64 globalTimer;
+
+	void DoState(PointerWrap &p) {
+		auto s = p.Section("CoreTiming", 1, 3);
+		Do(p, numEventTypes);
+		for (CoreTiming::BaseEvent &ev : events) {
+			u8 shouldExist = 1;
+			Do(p, shouldExist);
+			Do(p, ev.time);
+			Do(p, ev.userdata);
+			Do(p, ev.type);
+		}
+		u8 shouldExist = 0;
+		Do(p, shouldExist);
+		// The old threadsafe event list, always empty.
+		Do(p, shouldExist);
+
+		int cpuHz = CoreTiming::GetClockFrequencyHz();
+		s64 idledCycles = 0;
+		s64 lastGlobalTimeTicks = 0;
+		s64 lastGlobalTimeUs = 0;
+		Do(p, cpuHz);
+		Do(p, slicelength);
+		Do(p, globalTimer);
+		Do(p, idledCycles);
+		Do(p, lastGlobalTimeTicks);
+		Do(p, lastGlobalTimeUs);
+	}
+};
+
+static bool CheckScheduled(const std::vector<std::pair<int, u64>> &expected, const std::vector<s64> &times) {
+	std::vector<CoreTiming::BaseEvent> events = CoreTiming::GetScheduledEvents();
+	EXPECT_EQ_INT(events.size(), expected.size());
+	for (size_t i = 0; i < events.size(); ++i) {
+		EXPECT_EQ_INT(events[i].type, expected[i].first);
+		EXPECT_EQ_INT(events[i].userdata, expected[i].second);
+		EXPECT_EQ_INT(events[i].time, times[i]);
+	}
+	return true;
+}
+
+bool TestCoreTiming() {
+	firedEvents.clear();
+	CoreTiming::Init();
+	eventA = CoreTiming::RegisterEvent("TestEventA", &EventCallbackA);
+	eventB = CoreTiming::RegisterEvent("TestEventB", &EventCallbackB);
+	eventC = CoreTiming::RegisterEvent("TestEventC", &EventCallbackC);
+
+	CoreTiming::ScheduleEvent(100, eventA, 1);
+	CoreTiming::ScheduleEvent(50, eventB, 2);
+	CoreTiming::ScheduleEvent(100, eventC, 3);
+	CoreTiming::ScheduleEvent(100, eventA, 4);
+	CoreTiming::ScheduleEvent(200, eventB, 5);
+	CoreTiming::ScheduleEvent(300, eventC, 6);
+
+	// Returns the cycles that were left.
+	EXPECT_EQ_INT(CoreTiming::UnscheduleEvent(eventB, 5), 200);
+	EXPECT_EQ_INT(CoreTiming::UnscheduleEvent(eventB, 5), 0);
+	EXPECT_TRUE(CoreTiming::IsScheduled(eventB));
+
+	CoreTiming::RemoveEvent(eventC);
+	EXPECT_FALSE(CoreTiming::IsScheduled(eventC));
+	EXPECT_TRUE(CoreTiming::IsScheduled(eventA));
+	// Lands on the same time as the two A events, so it runs after them.
+	CoreTiming::ScheduleEvent(100, eventC, 7);
+	CoreTiming::ScheduleEvent(400, eventA, 8);
+
+	const std::vector<std::pair<int, u64>> expected = {
+		{ eventB, 2 },
+		{ eventA, 1 },
+		{ eventA, 4 },
+		{ eventC, 7 },
+		{ eventA, 8 },
+	};
+	const std::vector<s64> expectedTimes = { 50, 100, 100, 100, 400 };
+	RET(CheckScheduled(expected, expectedTimes));
+
+	// Save, and make sure it's exactly what the old linked list would have written.
+	CoreTimingState state;
+	std::vector<u8> saved;
+	EXPECT_TRUE(CChunkFileReader::MeasureAndSavePtr(state, &saved) == CChunkFileReader::ERROR_NONE);
+
+	OldLayoutState oldLayout;
+	oldLayout.numEventTypes = 3;
+	oldLayout.slicelength = CoreTiming::slicelength;
+	oldLayout.globalTimer = (s64)CoreTiming::GetTicks() - CoreTiming::slicelength + currentMIPS->downcount;
+	for (size_t i = 0; i < expected.size(); ++i)
+		oldLayout.events.push_back(CoreTiming::BaseEvent{ expectedTimes[i], expected[i].second, expected[i].first });
+	std::vector<u8> oldSaved;
+	EXPECT_TRUE(CChunkFileReader::MeasureAndSavePtr(oldLayout, &oldSaved) == CChunkFileReader::ERROR_NONE);
+	EXPECT_EQ_INT(saved.size(), oldSaved.size());
+	EXPECT_TRUE(memcmp(saved.data(), oldSaved.data(), saved.size()) == 0);
+
+	// Mess up the queue, then load it back.
+	CoreTiming::RemoveEvent(eventA);
+	CoreTiming::ScheduleEvent(10, eventB, 9);
+
+	std::string errorString;
+	EXPECT_TRUE(CChunkFileReader::LoadPtr(oldSaved.data(), state, &errorString) == CChunkFileReader::ERROR_NONE);
+	CoreTiming::RestoreRegisterEvent(eventA, "TestEventA", &EventCallbackA);
+	CoreTiming::RestoreRegisterEvent(eventB, "TestEventB", &EventCallbackB);
+	CoreTiming::RestoreRegisterEvent(eventC, "TestEventC", &EventCallbackC);
+	RET(CheckScheduled(expected, expectedTimes));
+
+	// The type chains have to survive the load too.
+	EXPECT_EQ_INT(CoreTiming::UnscheduleEvent(eventA, 8), 400);
+	CoreTiming::ScheduleEvent(100, eventB, 10);
+
+	RunUntil(1000);
+	const std::vector<std::pair<int, u64>> expectedFired = {
+		{ eventB, 2 },
+		{ eventA, 1 },
+		{ eventA, 4 },
+		{ eventC, 7 },
+		{ eventB, 10 },
+	};
+	EXPECT_EQ_INT(firedEvents.size(), expectedFired.size());
+	for (size_t i = 0; i < firedEvents.size(); ++i) {
+		EXPECT_EQ_INT(firedEvents[i].first, expectedFired[i].first);
+		EXPECT_EQ_INT(firedEvents[i].second, expectedFired[i].second);
+	}
+	EXPECT_TRUE(CoreTiming::GetScheduledEvents().empty());
+
+	CoreTiming::Shutdown();
+	return true;
+}
@@ -0,0 +1,150 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <zstd.h>
+
+#include "Common/CPUDetect.h"
+#include "Common/File/FileUtil.h"
+#include "Common/File/Path.h"
+#include "Common/Serialize/Serializer.h"
+#include "Common/Serialize/SerializeFuncs.h"
+#include "Common/StringUtils.h"
+#include "Common/Thread/ThreadManager.h"
+
+#include "UnitTest.h"
+
+struct BlobState {
+	std::vector<u8> data;
+
+	void DoState(PointerWrap &p) {
+		auto s = p.Section("BlobState", 1);
+		if (!s)
+			return;
+		Do(p, data);
+	}
+};
+
+// Mirrors CChunkFileReader's file header, as written by revision 5 (with a title.)
+struct OldChunkHeader {
+	int Revision;
+	int Compress;
+	u32 ExpectedSize;
+	u32 UncompressedSize;
+	char GitVersion[32];
+};
+
+static void FillBlob(BlobState &state, size_t size) {
+	state.data.resize(size);
+	// Something zstd can squeeze a bit, but not into nothing.
+	u32 seed = 0x1234567;
+	for (size_t i = 0; i < size; ++i) {
+		seed = seed * 1103515245 + 12345;
+		state.data[i] = (i & 0x100) ? (u8)(seed >> 16) : (u8)(i >> 9);
+	}
+}
+
+static bool ReadCompressedPart(const Path &filename, std::vector<u8> &compressed) {
+	std::string contents;
+	EXPECT_TRUE(File::ReadBinaryFileToString(filename, &contents));
+	const size_t headerSize = sizeof(OldChunkHeader) + 128;
+	EXPECT_TRUE(contents.size() > headerSize);
+	compressed.assign(contents.begin() + headerSize, contents.end());
+	return true;
+}
+
+static int CountZstdFrames(const std::vector<u8> &compressed) {
+	int frames = 0;
+	size_t pos = 0;
+	while (pos < compressed.size()) {
+		size_t frameSize = ZSTD_findFrameCompressedSize(compressed.data() + pos, compressed.size() - pos);
+		if (ZSTD_isError(frameSize))
+			return -1;
+		pos += frameSize;
+		frames++;
+	}
+	return frames;
+}
+
+static bool TestRoundTrip(const Path &filename, size_t size, int expectedFrames) {
+	BlobState state;
+	FillBlob(state, size);
+	EXPECT_TRUE(CChunkFileReader::Save(filename, "Test title", "v1.2.3-test", state) == CChunkFileReader::ERROR_NONE);
+
+	std::vector<u8> compressed;
+	RET(ReadCompressedPart(filename, compressed));
+	EXPECT_EQ_INT(CountZstdFrames(compressed), expectedFrames);
+
+	std::string title;
+	EXPECT_TRUE(CChunkFileReader::GetFileTitle(filename, &title) == CChunkFileReader::ERROR_NONE);
+	EXPECT_EQ_STR(title, std::string("Test title"));
+
+	BlobState loaded;
+	std::string gitVersion;
+	std::string failureReason;
+	EXPECT_TRUE(CChunkFileReader::Load(filename, &gitVersion, loaded, &failureReason) == CChunkFileReader::ERROR_NONE);
+	EXPECT_EQ_STR(gitVersion, std::string("v1.2.3-test"));
+	EXPECT_EQ_INT(loaded.data.size(), state.data.size());
+	EXPECT_TRUE(loaded.data == state.data);
+
+	// A damaged frame anywhere must fail the load, not come back half empty.
+	File::IOFile file(filename, "r+b");
+	EXPECT_TRUE(file.Seek(sizeof(OldChunkHeader) + 128 + compressed.size() / 2, SEEK_SET));
+	u8 garbage[64];
+	memset(garbage, 0xAA, sizeof(garbage));
+	EXPECT_TRUE(file.WriteArray(garbage, sizeof(garbage)));
+	file.Close();
+	EXPECT_FALSE(CChunkFileReader::Load(filename, &gitVersion, loaded, &failureReason) == CChunkFileReader::ERROR_NONE);
+	return true;
+}
+
+// States saved before the chunking were one zstd frame for the whole thing.
+static bool TestOldSingleFrame(const Path &filename, size_t size) {
+	BlobState state;
+	FillBlob(state, size);
+	std::vector<u8> uncompressed;
+	EXPECT_TRUE(CChunkFileReader::MeasureAndSavePtr(state, &uncompressed) == CChunkFileReader::ERROR_NONE);
+
+	std::vector<u8> compressed(ZSTD_compressBound(uncompressed.size()));
+	size_t compressedSize = ZSTD_compress(compressed.data(), compressed.size(), uncompressed.data(), uncompressed.size(), ZSTD_CLEVEL_DEFAULT);
+	EXPECT_FALSE(ZSTD_isError(compressedSize));
+	compressed.resize(compressedSize);
+
+	OldChunkHeader header{};
+	header.Revision = 5;
+	header.Compress = 2;
+	header.ExpectedSize = (u32)compressed.size();
+	header.UncompressedSize = (u32)uncompressed.size();
+	truncate_cpy(header.GitVersion, "v1.17.1");
+	char titleFixed[128]{};
+	truncate_cpy(titleFixed, "Old title");
+
+	File::IOFile file(filename, "wb");
+	EXPECT_TRUE(file.WriteArray(&header, 1));
+	EXPECT_TRUE(file.WriteArray(titleFixed, sizeof(titleFixed)));
+	EXPECT_TRUE(file.WriteBytes(compressed.data(), compressed.size()));
+	file.Close();
+
+	BlobState loaded;
+	std::string gitVersion;
+	std::string failureReason;
+	EXPECT_TRUE(CChunkFileReader::Load(filename, &gitVersion, loaded, &failureReason) == CChunkFileReader::ERROR_NONE);
+	EXPECT_EQ_STR(gitVersion, std::string("v1.17.1"));
+	EXPECT_TRUE(loaded.data == state.data);
+	return true;
+}
+
+bool TestSerializer() {
+	// Chunks are compressed and decompressed on the thread manager.
+	if (!g_threadManager.IsInitialized())
+		g_threadManager.Init(cpu_info.num_cores, cpu_info.logical_cpu_count);
+
+	const Path filename("unittest_savestate.ppst");
+	bool success = TestRoundTrip(filename, 1000, 1);
+	// A bit over two chunks, so the last one is short.
+	success = success && TestRoundTrip(filename, 9 * 1024 * 1024 + 123, 3);
+	success = success && TestOldSingleFrame(filename, 1000);
+	success = success && TestOldSingleFrame(filename, 9 * 1024 * 1024 + 123);
+	File::Delete(filename);
+	return success;
+}
@@ -0,0 +1,219 @@
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#include "Common/Serialize/Serializer.h"
+#include "Common/Serialize/SerializeFuncs.h"
+#include "Core/HLE/ThreadQueueList.h"
+
+#include "UnitTest.h"
+
+static bool CheckQueue(ThreadQueueList &list, u32 priority, const std::deque<SceUID> &expected) {
+	EXPECT_EQ_INT(list.empty(priority), expected.empty());
+	for (SceUID id : expected) {
+		EXPECT_EQ_INT(list.contains(id), (int)priority);
+	}
+	return true;
+}
+
+static bool DrainQueue(ThreadQueueList &list, u32 priority, std::deque<SceUID> &expected) {
+	while (!expected.empty()) {
+		EXPECT_EQ_INT(list.pop_first_better(priority + 1), expected.front());
+		expected.pop_front();
+	}
+	EXPECT_TRUE(list.empty(priority));
+	return true;
+}
+
+static bool TestThreadQueueWraparound() {
+	ThreadQueueList list;
+	std::deque<SceUID> expected;
+	const u32 priority = 20;
+	list.prepare(priority);
+
+	// Move the start of the circular array along, so the items wrap around the end.
+	SceUID nextID = 1;
+	for (int i = 0; i < 20; ++i) {
+		list.push_back(priority, nextID);
+		expected.push_back(nextID++);
+	}
+	for (int i = 0; i < 15; ++i) {
+		EXPECT_EQ_INT(list.pop_first(), expected.front());
+		expected.pop_front();
+	}
+	for (int i = 0; i < 25; ++i) {
+		list.push_back(priority, nextID);
+		expected.push_back(nextID++);
+	}
+	RET(CheckQueue(list, priority, expected));
+
+	// Rotate and remove across the wrap point.
+	for (int i = 0; i < 7; ++i) {
+		list.rotate(priority);
+		expected.push_back(expected.front());
+		expected.pop_front();
+	}
+	list.remove(priority, expected[20]);
+	expected.erase(expected.begin() + 20);
+	list.remove(priority, expected[2]);
+	expected.erase(expected.begin() + 2);
+	// Not there, should do nothing.
+	list.remove(priority, 1000);
+	RET(CheckQueue(list, priority, expected));
+
+	// Now fill it past capacity while wrapped, from both ends, so grow() has to unwrap it.
+	for (int i = 0; i < 40; ++i) {
+		if (i & 1) {
+			list.push_front(priority, nextID);
+			expected.push_front(nextID++);
+		} else {
+			list.push_back(priority, nextID);
+			expected.push_back(nextID++);
+		}
+	}
+	RET(CheckQueue(list, priority, expected));
+	EXPECT_EQ_INT(list.peek_first(), expected.front());
+
+	list.rotate(priority);
+	expected.push_back(expected.front());
+	expected.pop_front();
+
+	RET(DrainQueue(list, priority, expected));
+	EXPECT_EQ_INT(list.peek_first(), 0);
+	return true;
+}
+
+static bool TestThreadQueuePriorities() {
+	ThreadQueueList list;
+	// Spread across all four words of the bitmap, including the edges between them.
+	const u32 priorities[] = { 127, 70, 64, 63, 40, 32, 31, 1 };
+	for (u32 priority : priorities) {
+		list.prepare(priority);
+		list.push_back(priority, 1000 + priority);
+	}
+
+	// Nothing better than the best one.
+	EXPECT_EQ_INT(list.pop_first_better(1), 0);
+	EXPECT_EQ_INT(list.pop_first_better(2), 1001);
+	EXPECT_EQ_INT(list.pop_first_better(31), 0);
+	EXPECT_EQ_INT(list.pop_first_better(32), 1031);
+	EXPECT_EQ_INT(list.pop_first_better(32), 0);
+	EXPECT_EQ_INT(list.pop_first_better(33), 1032);
+	EXPECT_EQ_INT(list.pop_first_better(40), 0);
+	EXPECT_EQ_INT(list.peek_first(), 1040);
+	EXPECT_EQ_INT(list.pop_first_better(64), 1040);
+	EXPECT_EQ_INT(list.pop_first_better(64), 1063);
+	EXPECT_EQ_INT(list.pop_first_better(64), 0);
+	EXPECT_EQ_INT(list.pop_first_better(65), 1064);
+	EXPECT_EQ_INT(list.pop_first_better(70), 0);
+	EXPECT_EQ_INT(list.pop_first_better(128), 1070);
+	EXPECT_EQ_INT(list.pop_first_better(127), 0);
+	EXPECT_EQ_INT(list.pop_first(), 1127);
+	EXPECT_EQ_INT(list.pop_first_better(128), 0);
+
+	// Emptying a level by removing must also clear its bit.
+	list.push_back(64, 5);
+	list.push_back(96, 6);
+	list.remove(64, 5);
+	EXPECT_EQ_INT(list.peek_first(), 6);
+	EXPECT_EQ_INT(list.pop_first_better(96), 0);
+	EXPECT_EQ_INT(list.pop_first_better(97), 6);
+	return true;
+}
+
+// The layout the ThreadQueueList savestate has always had: each queue's size, capacity, then items in order.
+struct OldThreadQueueLayout {
+	struct Level {
+		int size;
+		int capacity;
+		std::vector<SceUID> items;
+	};
+	Level levels[ThreadQueueList::NUM_QUEUES]{};
+
+	void DoState(PointerWrap &p) {
+		auto s = p.Section("ThreadQueueList", 1);
+		int numQueues = ThreadQueueList::NUM_QUEUES;
+		Do(p, numQueues);
+		for (Level &level : levels) {
+			Do(p, level.size);
+			Do(p, level.capacity);
+			if (level.capacity != 0 && level.size != 0)
+				DoArray(p, level.items.data(), level.size);
+		}
+	}
+};
+
+static bool TestThreadQueueDoState() {
+	// States saved before the queues were circular had capacities in steps of 32, and free space on both sides.
+	OldThreadQueueLayout oldLayout;
+	oldLayout.levels[3] = { 0, 32, {} };
+	oldLayout.levels[16] = { 3, 64, { 7, 8, 9 } };
+	oldLayout.levels[100] = { 31, 32, {} };
+	for (int i = 0; i < 31; ++i)
+		oldLayout.levels[100].items.push_back(200 + i);
+
+	std::vector<u8> oldSaved;
+	EXPECT_TRUE(CChunkFileReader::MeasureAndSavePtr(oldLayout, &oldSaved) == CChunkFileReader::ERROR_NONE);
+
+	ThreadQueueList list;
+	list.prepare(5);
+	list.push_back(5, 1234);
+	std::string errorString;
+	EXPECT_TRUE(CChunkFileReader::LoadPtr(oldSaved.data(), list, &errorString) == CChunkFileReader::ERROR_NONE);
+
+	// Whatever was there before is gone.
+	EXPECT_EQ_INT(list.contains(1234), -1);
+	EXPECT_TRUE(list.empty(3));
+	EXPECT_EQ_INT(list.peek_first(), 7);
+
+	// Wrap the items around and grow, then save. It has to come out in order again.
+	EXPECT_EQ_INT(list.pop_first_better(101), 7);
+	EXPECT_EQ_INT(list.pop_first_better(101), 8);
+	for (int i = 0; i < 40; ++i)
+		list.push_back(16, 10 + i);
+	// The third one wraps around to the end of the array.
+	list.push_front(16, 6);
+	list.push_front(16, 5);
+	list.push_front(16, 4);
+	// And this one has to unwrap when it grows.
+	list.rotate(100);
+	list.push_back(100, 300);
+	list.push_back(100, 301);
+
+	OldThreadQueueLayout expected;
+	expected.levels[3] = { 0, 32, {} };
+	expected.levels[16] = { 44, 64, { 4, 5, 6, 9 } };
+	for (int i = 0; i < 40; ++i)
+		expected.levels[16].items.push_back(10 + i);
+	expected.levels[100] = { 33, 64, {} };
+	for (int i = 1; i < 31; ++i)
+		expected.levels[100].items.push_back(200 + i);
+	expected.levels[100].items.push_back(200);
+	expected.levels[100].items.push_back(300);
+	expected.levels[100].items.push_back(301);
+
+	std::vector<u8> saved;
+	std::vector<u8> expectedSaved;
+	EXPECT_TRUE(CChunkFileReader::MeasureAndSavePtr(list, &saved) == CChunkFileReader::ERROR_NONE);
+	EXPECT_TRUE(CChunkFileReader::MeasureAndSavePtr(expected, &expectedSaved) == CChunkFileReader::ERROR_NONE);
+	EXPECT_EQ_INT(saved.size(), expectedSaved.size());
+	EXPECT_TRUE(memcmp(saved.data(), expectedSaved.data(), saved.size()) == 0);
+
+	// And back in.
+	ThreadQueueList reloaded;
+	EXPECT_TRUE(CChunkFileReader::LoadPtr(saved.data(), reloaded, &errorString) == CChunkFileReader::ERROR_NONE);
+	std::deque<SceUID> level16(expected.levels[16].items.begin(), expected.levels[16].items.end());
+	std::deque<SceUID> level100(expected.levels[100].items.begin(), expected.levels[100].items.end());
+	RET(DrainQueue(reloaded, 16, level16));
+	RET(DrainQueue(reloaded, 100, level100));
+	EXPECT_EQ_INT(reloaded.peek_first(), 0);
+	return true;
+}
+
+bool TestThreadQueueList() {
+	RET(TestThreadQueueWraparound());
+	RET(TestThreadQueuePriorities());
+	RET(TestThreadQueueDoState());
+	return true;
+}
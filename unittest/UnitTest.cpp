@@ -626,6 +626,43 @@ bool TestQuickTexHash() {
 	return true;
 }
 
+bool TestFastQuickTexHash() {
+	static const int BUF_SIZE = 4096 + 256;
+	AlignedMem buf(BUF_SIZE, 32);
+
+	int j = 573;
+	for (int i = 0; i < BUF_SIZE; ++i) {
+		char *p = buf;
+		j += ((i * 7) + (i & 3)) * 11;
+		p[i] = j & 0xFF;
+	}
+
+	const char *base = buf;
+	EXPECT_EQ_HEX(FastQuickTexHashGeneric(base, 1024), 0x649a3bf8);
+	EXPECT_EQ_HEX(FastQuickTexHashGeneric(base + 1, 128), 0x75e2a3a0);
+
+	// Unaligned starts, and sizes the wide kernel does and doesn't take.
+	static const int offsets[] = { 0, 1, 4, 16, 31, 32 };
+	static const u32 sizes[] = { 0, 8, 64, 72, 128, 192, 1000, 1024, 4096 };
+	for (int offset : offsets) {
+		for (u32 size : sizes) {
+			const char *p = base + offset;
+			u32 generic = FastQuickTexHashGeneric(p, size);
+			if ((size & 0x7f) != 0) {
+				// Too small or odd sizes always use the stable hash.
+				EXPECT_EQ_HEX(generic, StableQuickTexHash(p, size));
+				EXPECT_EQ_HEX(FastQuickTexHash(p, size), StableQuickTexHash(p, size));
+			} else if (cpu_info.bAVX2) {
+				EXPECT_EQ_HEX(FastQuickTexHash(p, size), generic);
+			} else {
+				EXPECT_EQ_HEX(FastQuickTexHash(p, size), StableQuickTexHash(p, size));
+			}
+		}
+	}
+
+	return true;
+}
+
 bool TestCLZ() {
 	static const uint32_t input[] = {
 		0xFFFFFFFF,
@@ -1248,6 +1285,9 @@ bool TestSoftwareGPUJit();
 bool TestIRPassSimplify();
 bool TestThreadManager();
 bool TestVFS();
+bool TestSerializer();
+bool TestThreadQueueList();
+bool TestCoreTiming();
 
 TestItem availableTests[] = {
 #if PPSSPP_ARCH(ARM64) || PPSSPP_ARCH(AMD64) || PPSSPP_ARCH(X86)
@@ -1273,6 +1313,7 @@ TestItem availableTests[] = {
 	TEST_ITEM(VFPUMatrixTranspose),
 	TEST_ITEM(ParseLBN),
 	TEST_ITEM(QuickTexHash),
+	TEST_ITEM(FastQuickTexHash),
 	TEST_ITEM(CLZ),
 	TEST_ITEM(MemMap),
 	TEST_ITEM(ShaderGenerators),
@@ -1296,6 +1337,9 @@ TestItem availableTests[] = {
 	TEST_ITEM(SIMD),
 	TEST_ITEM(CrossSIMD),
 	TEST_ITEM(VolumeFunc),
+	TEST_ITEM(Serializer),
+	TEST_ITEM(ThreadQueueList),
+	TEST_ITEM(CoreTiming),
 };
 
 int main(int argc, const char *argv[]) {